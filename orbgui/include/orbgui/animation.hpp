@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include <orb/result.hpp>
+
+namespace orb::gui
+{
+    // Parameters the vertex shader applies to the vertices of a node, they
+    // land at `linear * position + translate`. Matches main.vs.glsl
+    struct node_params_t
+    {
+        std::array<f32, 4> linear    = { 1.0f, 0.0f, 0.0f, 1.0f }; // 2x2, column major
+        std::array<f32, 2> translate = { 0.0f, 0.0f };
+        f32                opacity   = 1.0f;
+        f32                reserved  = 0.0f;
+    };
+
+    static_assert(sizeof(node_params_t) == 32);
+
+    // Always the identity, vertices belong to it unless told otherwise
+    static constexpr ui32 root_node = 0;
+
+    enum class node_channel : ui32
+    {
+        translate_x, // in normalized device coordinates, like the vertices
+        translate_y,
+        scale_x,     // around the pivot
+        scale_y,
+        rotation,    // radians, around the pivot
+        opacity,
+    };
+
+    static constexpr ui32 node_channel_count = 6;
+
+    enum class easing : ui8
+    {
+        linear,
+        ease_in,
+        ease_out,
+        ease_in_out,
+    };
+
+    // Transform and opacity of the nodes vertices reference. Animations are
+    // evaluated once per frame into a small parameter table the GPU reads,
+    // so scrolling, fading or zooming a widget never touches its vertices
+    class animator_t
+    {
+    public:
+        animator_t();
+
+        // New node with identity parameters, indices of destroyed nodes get reused
+        auto create_node() -> ui32;
+        void destroy_node(ui32 node);
+
+        // Setters and animate() ignore the root, unknown and destroyed nodes
+
+        // Sets the channel right away, cancelling its running animation
+        void set(ui32 node, node_channel channel, f32 value);
+        void set_pivot(ui32 node, f32 x, f32 y);
+
+        // Tweens the channel from its current value to `target`. The animation
+        // starts at the next evaluate() and replaces the one already running
+        void animate(ui32 node, node_channel channel, f32 target, f64 duration_ms, easing ease = easing::ease_out);
+
+        [[nodiscard]] auto value(ui32 node, node_channel channel) const -> f32;
+
+        // Some animation is running, the caller should keep rendering
+        [[nodiscard]] auto animating() const -> bool { return !m_curves.empty(); }
+
+        // Advances the running animations to `time_ms` and refreshes the
+        // parameters of the nodes that changed since the last call
+        void evaluate(f64 time_ms);
+
+        [[nodiscard]] auto params() const -> std::span<const node_params_t> { return m_params; }
+        [[nodiscard]] auto node_count() const -> ui32 { return static_cast<ui32>(m_nodes.size() - m_free.size()); }
+
+    private:
+        struct node_t
+        {
+            std::array<f32, node_channel_count> values;
+            std::array<f32, 2>                  pivot = { 0.0f, 0.0f };
+            bool                                alive = true;
+            bool                                dirty = false;
+        };
+
+        struct curve_t
+        {
+            ui32         node;
+            node_channel channel;
+            f32          from;
+            f32          to;
+            f64          start; // negative until the first evaluate()
+            f64          duration;
+            easing       ease;
+        };
+
+        std::vector<node_t>        m_nodes;
+        std::vector<node_params_t> m_params;
+        std::vector<ui32>          m_free;
+        std::vector<curve_t>       m_curves;
+        std::vector<ui32>          m_dirty;
+
+        void cancel(ui32 node, node_channel channel);
+        void touch(ui32 node);
+        void refresh(ui32 node);
+
+        // Not the root, in range and alive
+        [[nodiscard]] auto writable(ui32 node) const -> bool;
+    };
+} // namespace orb::gui
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include "orbgui/animation.hpp"
+#include "orbgui/clip.hpp"
+
+namespace orb::gui
+{
+    // Capture file layout: a capture_header_t followed by records. Each record
+    // is a capture_record_header_t and its payload, padded to 8 bytes. A frame
+    // is the records between frame_begin and frame_end
+    static constexpr std::array<char, 8> capture_magic   = { 'O', 'R', 'B', 'G', 'C', 'A', 'P', '\0' };
+    static constexpr ui32                capture_version = 3;
+
+    // Buffer identifiers in frame streams. Plot vertex buffers follow, in
+    // creation order
+    static constexpr ui32 capture_quad_vertices = 0;
+    static constexpr ui32 capture_quad_indices  = 1;
+    static constexpr ui32 capture_band_indices  = 2;
+    static constexpr ui32 capture_first_plot    = 3;
+
+    enum class capture_record : ui32
+    {
+        frame_begin,    // capture_frame_begin_t
+        buffer_create,  // capture_buffer_create_t
+        buffer_upload,  // capture_buffer_upload_t, then the uploaded bytes
+        viewport_begin, // capture_viewport_t, the following draws target it
+        draw,           // capture_draw_t
+        frame_end,      // no payload
+        clip_entries,   // the clip_entry_t the following draws index
+        node_params,    // the node_params_t the vertices index
+    };
+
+    enum class capture_buffer_usage : ui32
+    {
+        vertex,
+        index,
+    };
+
+    struct capture_header_t
+    {
+        std::array<char, 8> magic;
+        ui32                version;
+        ui32                vertex_size;
+    };
+
+    struct capture_record_header_t
+    {
+        capture_record type;
+        ui32           size;
+    };
+
+    struct capture_frame_begin_t
+    {
+        ui64 frame;
+    };
+
+    struct capture_buffer_create_t
+    {
+        ui32                 buffer;
+        capture_buffer_usage usage;
+        ui64                 size;
+    };
+
+    struct capture_buffer_upload_t
+    {
+        ui32 buffer;
+        ui32 reserved;
+        ui64 offset;
+        ui64 size;
+    };
+
+    struct capture_viewport_t
+    {
+        ui32 viewport;
+        ui32 width;
+        ui32 height;
+        i32  scissor_x;
+        i32  scissor_y;
+        ui32 scissor_width;
+        ui32 scissor_height;
+        ui32 reserved;
+    };
+
+    struct capture_draw_t
+    {
+        ui32 vertex_buffer;
+        ui32 index_buffer;
+        ui32 first_index;
+        ui32 index_count;
+        i32  vertex_offset;
+        ui32 clip;
+    };
+
+    // Records frames into memory and hands them to a writer thread at the end
+    // of each frame, the render thread never touches the file. The frames
+    // queued for it are bounded, end_frame() waits when the disk falls behind
+    class capture_writer_t
+    {
+    public:
+        ~capture_writer_t();
+
+        capture_writer_t(capture_writer_t const&)                        = delete;
+        capture_writer_t(capture_writer_t&&) noexcept                    = default;
+        auto operator=(capture_writer_t const&) -> capture_writer_t&     = delete;
+        auto operator=(capture_writer_t&&) noexcept -> capture_writer_t& = default;
+
+        static auto create(std::filesystem::path const& file) -> orb::result<capture_writer_t>;
+
+        void begin_frame(ui64 frame);
+        void create_buffer(ui32 buffer, capture_buffer_usage usage, ui64 size);
+        void upload(ui32 buffer, ui64 offset, std::span<const std::byte> data);
+        void viewport(capture_viewport_t const& viewport);
+        void draw(capture_draw_t const& draw);
+        void clips(std::span<const clip_entry_t> entries);
+        void nodes(std::span<const node_params_t> params);
+        void end_frame();
+
+        // Frames end_frame() had to wait for the writer thread
+        [[nodiscard]] auto stalls() const -> ui64;
+
+        // Flushes the pending frames and closes the file
+        auto finish() -> orb::result<void>;
+
+    private:
+        struct stream_t;
+
+        box<stream_t> m_stream;
+
+        explicit capture_writer_t(box<stream_t> stream);
+    };
+
+    struct capture_frame_t
+    {
+        ui64                       frame;
+        std::span<const std::byte> records;
+    };
+
+    struct capture_record_view_t
+    {
+        capture_record             type;
+        std::span<const std::byte> payload;
+
+        // Only valid when holds<T>()
+        template <typename T>
+        [[nodiscard]] auto as() const -> T const&
+        {
+            return *reinterpret_cast<T const*>(payload.data());
+        }
+
+        template <typename T>
+        [[nodiscard]] auto holds() const -> bool
+        {
+            return payload.size() >= sizeof(T);
+        }
+    };
+
+    // Pops the record at the front of `records`, an error when its header or
+    // payload runs past the end
+    auto next_capture_record(std::span<const std::byte>& records) -> orb::result<capture_record_view_t>;
+
+    // Read-only, memory mapped capture. Frames reference the mapping directly
+    class capture_file_t
+    {
+    public:
+        ~capture_file_t();
+
+        capture_file_t(capture_file_t const&)                        = delete;
+        capture_file_t(capture_file_t&&) noexcept                    = default;
+        auto operator=(capture_file_t const&) -> capture_file_t&     = delete;
+        auto operator=(capture_file_t&&) noexcept -> capture_file_t& = default;
+
+        static auto open(std::filesystem::path const& file) -> orb::result<capture_file_t>;
+
+        [[nodiscard]] auto frames() const -> std::span<const capture_frame_t> { return m_frames; }
+
+    private:
+        struct mapping_t;
+
+        box<mapping_t>               m_mapping;
+        std::vector<capture_frame_t> m_frames;
+
+        explicit capture_file_t(box<mapping_t> mapping);
+    };
+
+    struct replay_upload_t
+    {
+        ui32                       buffer;
+        ui64                       offset;
+        std::span<const std::byte> data;
+    };
+
+    struct replay_pass_t
+    {
+        capture_viewport_t          viewport;
+        std::vector<capture_draw_t> draws;
+    };
+
+    // A captured frame decoded for replay, upload data and clips still point
+    // into the capture mapping
+    struct replay_frame_t
+    {
+        ui64                                 frame = 0;
+        std::vector<capture_buffer_create_t> creates;
+        std::vector<replay_upload_t>         uploads;
+        std::vector<replay_pass_t>           passes;
+        std::span<const clip_entry_t>        clips; // empty: unclipped
+        std::span<const node_params_t>       nodes; // empty: untransformed
+
+        void clear();
+    };
+
+    auto decode_capture_frame(capture_frame_t const& frame, replay_frame_t& out) -> orb::result<void>;
+} // namespace orb::gui
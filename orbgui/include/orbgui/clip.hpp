@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include <orb/result.hpp>
+
+namespace orb::gui
+{
+    // Clip rectangle in viewport pixels, corners rounded by `radius`
+    struct clip_rect_t
+    {
+        f32 x;
+        f32 y;
+        f32 width;
+        f32 height;
+        f32 radius = 0.0f;
+    };
+
+    // One clip as the shaders read it, selected per instance. Fragments are
+    // kept inside `bounds`, the intersection of the whole stack, and inside
+    // `rect` rounded by `radius`, the innermost clip. Only the innermost clip
+    // keeps its rounded corners, outer ones clip to their bounding box
+    struct clip_entry_t
+    {
+        std::array<f32, 4> rect;   // x0, y0, x1, y1
+        std::array<f32, 4> bounds; // x0, y0, x1, y1
+        f32                radius;
+        f32                reserved;
+    };
+
+    // Nested clips for the widgets of a frame. Widgets reference an entry by
+    // index, so changing clip never changes pipeline state. Entries stay valid
+    // until reset(), a GUI rebuilding its stack in the same order every frame
+    // keeps the same indices
+    class clip_stack_t
+    {
+    public:
+        // Entry of the unclipped root, always present
+        static constexpr ui32 no_clip = 0;
+
+        clip_stack_t();
+
+        void reset();
+
+        // Pushes `rect` intersected with the current clip and returns its index
+        auto push(clip_rect_t const& rect) -> ui32;
+        void pop();
+
+        [[nodiscard]] auto current() const -> ui32 { return m_stack.back(); }
+        [[nodiscard]] auto entries() const -> std::span<const clip_entry_t> { return m_entries; }
+
+    private:
+        std::vector<clip_entry_t> m_entries;
+        std::vector<ui32>         m_stack;
+    };
+} // namespace orb::gui
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <span>
+#include <vector>
+
+#include <orb/result.hpp>
+
+#include "orbgui/clip.hpp"
+#include "orbgui/vertex.hpp"
+
+namespace orb::gui
+{
+    // Indexed draw of a segment, `clip` indexes the segment's own clips
+    struct draw_cmd_t
+    {
+        ui32 layer;
+        ui32 clip;
+        ui32 first_index;
+        ui32 index_count;
+        i32  vertex_offset;
+    };
+
+    // Content of a draw list as published, commands sorted by layer
+    struct draw_segment_t
+    {
+        std::vector<vertex_t>   vertices;
+        std::vector<ui16>       indices;
+        std::vector<draw_cmd_t> commands;
+        clip_stack_t            clips;
+        ui64                    version = 0;
+
+        void clear();
+    };
+
+    struct draw_list_create_info_t
+    {
+        ui32 viewport = 0;
+        ui32 layer    = 0; // initial layer, lower layers are drawn first
+    };
+
+    // Immediate mode geometry from one producer thread. The producer records
+    // then publishes, the render thread picks the latest published segment on
+    // each render. Segments are triple buffered behind a single atomic, so
+    // neither side ever waits for the other and a producer may publish at any
+    // cadence. Each draw list must only be recorded by one thread at a time
+    class draw_list_t
+    {
+    public:
+        explicit draw_list_t(ui32 layer);
+
+        draw_list_t(draw_list_t const&)                    = delete;
+        draw_list_t(draw_list_t&&)                         = delete;
+        auto operator=(draw_list_t const&) -> draw_list_t& = delete;
+        auto operator=(draw_list_t&&) -> draw_list_t&      = delete;
+
+        // producer side
+        void set_layer(ui32 layer) { m_layer = layer; }
+        void set_node(ui32 node) { m_node = node; } // of the following rects
+        void push_clip(clip_rect_t const& rect);
+        void pop_clip();
+
+        // Vertices in normalized device coordinates, indices relative to them.
+        // Meshes keep the nodes of their vertices
+        void add_mesh(std::span<const vertex_t> vertices, std::span<const ui16> indices);
+        void add_rect(f32 x0, f32 y0, f32 x1, f32 y1, std::array<f32, 3> const& color);
+
+        // Hands the recorded content over and starts an empty segment
+        void publish();
+
+        // render thread side: the most recently published segment
+        [[nodiscard]] auto acquire() -> draw_segment_t const&;
+
+    private:
+        static constexpr ui32 fresh = 4;
+
+        std::array<draw_segment_t, 3> m_segments;
+
+        // producer
+        ui32 m_write     = 0;
+        ui32 m_layer     = 0;
+        ui32 m_node      = 0;
+        ui64 m_published = 0;
+
+        // shared: index of the segment last published, `fresh` until acquired
+        alignas(64) std::atomic<ui32> m_ready { 2 };
+
+        // render thread
+        alignas(64) ui32 m_read = 1;
+    };
+} // namespace orb::gui
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include <orb/result.hpp>
+
+namespace orb::gui
+{
+    // Solid rectangle of an instance set, laid out as the culling shader reads it
+    struct instance_item_t
+    {
+        std::array<f32, 4>  rect;  // x0, y0, x1, y1 in canvas units
+        std::array<f32, 4>  color; // rgb, alpha unused
+        ui32                clip;  // index into the instance clips
+        std::array<ui32, 3> reserved = {};
+    };
+
+    static_assert(sizeof(instance_item_t) == 48);
+
+    // Canvas to pixels: pixel = canvas * scale + offset
+    struct canvas_transform_t
+    {
+        std::array<f32, 2> scale  = { 1.0f, 1.0f };
+        std::array<f32, 2> offset = { 0.0f, 0.0f };
+    };
+
+    struct instance_set_create_info_t
+    {
+        ui32 viewport = 0;
+        ui32 capacity;
+    };
+
+    // Items written since the last render, `first_pending` indexing the pending items
+    struct instance_upload_t
+    {
+        ui32 first_item;
+        ui32 item_count;
+        ui32 first_pending;
+    };
+
+    // Large collection of rectangles living on the GPU. Items are only sent
+    // when written: culling against the viewport and the clips, compaction
+    // and draw generation all run in a compute pass, so the per frame CPU
+    // cost does not depend on the item count. Render thread only
+    class instance_set_t
+    {
+    public:
+        explicit instance_set_t(instance_set_create_info_t const& info);
+
+        // Items [first, first + items.size()) are replaced on the next render
+        auto write(ui32 first, std::span<const instance_item_t> items) -> orb::result<void>;
+
+        // Items past `count` are no longer drawn, their content is kept
+        auto resize(ui32 count) -> orb::result<void>;
+
+        void set_transform(canvas_transform_t const& transform) { m_transform = transform; }
+
+        [[nodiscard]] auto viewport() const -> ui32 { return m_viewport; }
+        [[nodiscard]] auto count() const -> ui32 { return m_count; }
+        [[nodiscard]] auto capacity() const -> ui32 { return m_capacity; }
+        [[nodiscard]] auto transform() const -> canvas_transform_t const& { return m_transform; }
+
+        // renderer side
+        [[nodiscard]] auto uploads() const -> std::span<const instance_upload_t> { return m_uploads; }
+        [[nodiscard]] auto pending() const -> std::span<const instance_item_t> { return m_pending; }
+        void               clear_uploads();
+
+    private:
+        ui32                           m_viewport;
+        ui32                           m_capacity;
+        ui32                           m_count = 0;
+        canvas_transform_t             m_transform;
+        std::vector<instance_upload_t> m_uploads;
+        std::vector<instance_item_t>   m_pending;
+    };
+} // namespace orb::gui
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <orb/result.hpp>
+
+namespace orb::gui
+{
+    static constexpr f32 layout_unbounded = std::numeric_limits<f32>::infinity();
+    static constexpr f32 layout_auto      = -1.0f;
+
+    using layout_node_t = ui32;
+
+    static constexpr layout_node_t no_layout_node = std::numeric_limits<ui32>::max();
+
+    struct layout_size_t
+    {
+        f32 width  = 0.0f;
+        f32 height = 0.0f;
+
+        auto operator==(layout_size_t const&) const -> bool = default;
+    };
+
+    struct layout_rect_t
+    {
+        f32 x      = 0.0f;
+        f32 y      = 0.0f;
+        f32 width  = 0.0f;
+        f32 height = 0.0f;
+    };
+
+    // Range of sizes a parent allows, also the key of the measurement caches
+    struct layout_constraints_t
+    {
+        f32 min_width  = 0.0f;
+        f32 max_width  = layout_unbounded;
+        f32 min_height = 0.0f;
+        f32 max_height = layout_unbounded;
+
+        auto operator==(layout_constraints_t const&) const -> bool = default;
+
+        [[nodiscard]] static auto tight(f32 width, f32 height) -> layout_constraints_t
+        {
+            return { width, width, height, height };
+        }
+    };
+
+    enum class layout_kind : ui8
+    {
+        row,    // children side by side, left to right
+        column, // children stacked, top to bottom
+        grid,   // children fill `grid_columns` equal columns, row by row
+    };
+
+    enum class layout_align : ui8
+    {
+        start,
+        center,
+        end,
+        stretch,
+    };
+
+    struct layout_style_t
+    {
+        layout_kind  kind  = layout_kind::column;
+        layout_align align = layout_align::stretch; // of the children, on the cross axis
+
+        // Main axis share of the parent's free space, `basis` defaulting to the content
+        f32 grow   = 0.0f;
+        f32 shrink = 1.0f;
+        f32 basis  = layout_auto;
+
+        f32 width      = layout_auto;
+        f32 height     = layout_auto;
+        f32 min_width  = 0.0f;
+        f32 max_width  = layout_unbounded;
+        f32 min_height = 0.0f;
+        f32 max_height = layout_unbounded;
+
+        std::array<f32, 4> padding      = {}; // left, top, right, bottom
+        f32                gap          = 0.0f;
+        ui32               grid_columns = 1;
+    };
+
+    // Content size of a leaf within the constraints, such as wrapped text
+    using layout_measure_t = std::function<layout_size_t(layout_constraints_t const&)>;
+
+    // Work done by the last update, to check that it stays proportional to
+    // what actually changed
+    struct layout_stats_t
+    {
+        ui32 laid_out    = 0;
+        ui32 measured    = 0;
+        ui32 cache_hits  = 0;
+        ui32 leaf_called = 0;
+    };
+
+    // Incremental flex and grid layout. Every node caches its measurements
+    // keyed by constraints, and its final layout with the constraints it was
+    // laid out with. Changes only dirty the node and its ancestors, so an
+    // update redoes the dirty path plus the subtrees whose constraints moved,
+    // and skips everything else. Positions are kept relative to the parent,
+    // a moved subtree is never visited
+    class layout_tree_t
+    {
+    public:
+        layout_tree_t();
+
+        [[nodiscard]] auto root() const -> layout_node_t { return 0; }
+
+        // Appends a child to `parent`
+        auto add(layout_node_t parent, layout_style_t const& style) -> orb::result<layout_node_t>;
+
+        // Removes the node and its subtree, their indices get reused
+        void remove(layout_node_t node);
+
+        void set_style(layout_node_t node, layout_style_t const& style);
+        void set_measure(layout_node_t node, layout_measure_t measure);
+
+        // Content of a leaf changed, its measurements are stale
+        void mark_dirty(layout_node_t node);
+
+        // Root size, such as the viewport extent
+        void set_size(f32 width, f32 height);
+
+        auto update() -> layout_stats_t;
+
+        // Results of the last update
+        [[nodiscard]] auto rect(layout_node_t node) const -> layout_rect_t;
+        [[nodiscard]] auto size(layout_node_t node) const -> layout_size_t { return m_nodes[node].size; }
+        [[nodiscard]] auto style(layout_node_t node) const -> layout_style_t const& { return m_nodes[node].style; }
+        [[nodiscard]] auto node_count() const -> ui32 { return static_cast<ui32>(m_nodes.size() - m_free.size()); }
+
+    private:
+        static constexpr ui32 measure_cache_size = 4;
+
+        struct measurement_t
+        {
+            layout_constraints_t constraints;
+            layout_size_t        size;
+        };
+
+        struct node_t
+        {
+            layout_style_t   style;
+            layout_measure_t measure;
+
+            layout_node_t parent       = no_layout_node;
+            layout_node_t first_child  = no_layout_node;
+            layout_node_t last_child   = no_layout_node;
+            layout_node_t next_sibling = no_layout_node;
+            layout_node_t prev_sibling = no_layout_node;
+
+            // measurements, round robin
+            std::array<measurement_t, measure_cache_size> measurements  = {};
+            ui32                                          measure_count = 0;
+            ui32                                          measure_next  = 0;
+
+            // final layout
+            layout_constraints_t constraints;
+            layout_size_t        size;
+            std::array<f32, 2>   offset = {}; // within the parent
+            bool                 dirty  = true;
+            bool                 alive  = true;
+        };
+
+        // Per child state of a container pass, on a shared stack
+        struct item_t
+        {
+            layout_node_t node;
+            f32           basis; // flex basis, kept while `main` is resolved
+            f32           main;
+            f32           cross;
+            f32           min_main;
+            f32           max_main;
+            bool          frozen;
+        };
+
+        std::vector<node_t>        m_nodes;
+        std::vector<layout_node_t> m_free;
+        std::vector<item_t>        m_items;
+        layout_constraints_t       m_root_constraints;
+        layout_stats_t             m_stats;
+
+        // Sizes the node, positioning its children only when `place` is set
+        auto compute(layout_node_t node, layout_constraints_t const& constraints, bool place) -> layout_size_t;
+        auto measure(layout_node_t node, layout_constraints_t const& constraints) -> layout_size_t;
+        auto layout(layout_node_t node, layout_constraints_t const& constraints) -> layout_size_t;
+
+        auto compute_flex(layout_node_t node, layout_constraints_t const& constraints, bool place) -> layout_size_t;
+        auto compute_grid(layout_node_t node, layout_constraints_t const& constraints, bool place) -> layout_size_t;
+    };
+} // namespace orb::gui
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <filesystem>
+#include <span>
+
 #include <orb/box.hpp>
 #include <orb/result.hpp>
 #include <orb/vk/enums.hpp>
@@ -8,6 +12,7 @@
 
 ORB_DEFINE_VK_HANDLE(VkQueue)
 ORB_DEFINE_VK_HANDLE(VkImage)
+ORB_DEFINE_VK_HANDLE(VkPhysicalDevice)
 
 namespace orb::vk
 {
@@ -18,6 +23,16 @@ namespace orb::vk
 namespace orb::gui
 {
     struct gui_renderer_t;
+    class animator_t;
+    class clip_stack_t;
+    class draw_list_t;
+    struct draw_list_create_info_t;
+    class instance_set_t;
+    struct instance_set_create_info_t;
+    class layout_tree_t;
+    struct plot_create_info_t;
+    class plot_t;
+    struct replay_frame_t;
 
     struct instance_create_info_t
     {
@@ -28,6 +43,76 @@ namespace orb::gui
         VkQueue            transfer_queue;
         ui32               graphics_qf;
         ui32               transfer_qf;
+        f32                timestamp_period = 0.0f; // ns per GPU timestamp tick, 0 disables GPU timings
+        VkPhysicalDevice   gpu              = nullptr; // required, the GPU of the device
+
+        // Holds main.vs.glsl and main.fs.glsl, and cull.comp.glsl and
+        // instance.vs.glsl once instance sets are used
+        std::filesystem::path shader_dir;
+
+        // Extensions enabled on the device. Budget checks need VK_EXT_memory_budget among them
+        std::span<const char* const> device_extensions;
+
+        // Instance set indirect draws need the multiDrawIndirect and
+        // drawIndirectFirstInstance features, `multi_draw_indirect` tells they
+        // are enabled and `draw_indirect_count` that drawIndirectCount is too
+        bool multi_draw_indirect = false;
+        bool draw_indirect_count = false;
+    };
+
+    // GPU memory is sub-allocated from pools of large blocks, one per category
+    enum class memory_category : ui32
+    {
+        streaming,      // vertex, index, storage and staging buffers
+        render_targets, // viewport images
+        atlases,        // sampled images
+    };
+
+    static constexpr ui32 memory_category_count = 3;
+
+    struct memory_category_usage_t
+    {
+        ui64 reserved_bytes = 0;    // held by the pool blocks
+        ui64 used_bytes     = 0;    // sub-allocated
+        ui32 blocks         = 0;
+        ui32 allocations    = 0;
+        f32  fragmentation  = 0.0f; // 1 - largest free range / free bytes
+    };
+
+    struct memory_usage_t
+    {
+        std::array<memory_category_usage_t, memory_category_count> categories = {};
+
+        // Device local heaps, for the whole process. Only with VK_EXT_memory_budget
+        ui64 budget_bytes = 0;
+        ui64 usage_bytes  = 0;
+    };
+
+    enum class pacing_mode
+    {
+        throughput,  // build as soon as the frame slot is free
+        low_latency, // build as late as the estimated frame cost allows
+    };
+
+    struct frame_pacing_t
+    {
+        pacing_mode mode            = pacing_mode::throughput;
+        f64         frame_period_ms = 1000.0 / 60.0;
+        f64         margin_ms       = 1.0;
+    };
+
+    struct frame_latency_t
+    {
+        ui64 frame                 = 0;
+        f64  input_to_submit_ms    = 0.0;
+        f64  submit_to_complete_ms = 0.0;
+        f64  gpu_ms                = 0.0;
+    };
+
+    struct viewport_create_info_t
+    {
+        ui32 extent_width;
+        ui32 extent_height;
     };
 
     class instance_t
@@ -43,10 +128,67 @@ namespace orb::gui
         static auto create(instance_create_info_t&& info) -> orb::result<instance_t>;
 
         auto render() -> orb::result<void>;
+        // Recreates the main viewport's targets at their current extent
         auto on_resize() -> orb::result<void>;
 
-        [[nodiscard]] auto rendered_image() const -> VkImage;
-        [[nodiscard]] auto render_finished() -> vk::semaphores_view_t&;
+        // Resizes the viewport's targets and its layout to the new extent
+        auto on_resize(ui32 viewport, ui32 width, ui32 height) -> orb::result<void>;
+
+        // Additional output surface sharing this instance's device objects. The
+        // main viewport, created from instance_create_info_t, has index 0
+        auto create_viewport(viewport_create_info_t const& info) -> orb::result<ui32>;
+
+        [[nodiscard]] auto viewport_count() const -> ui32;
+
+        // To be called once the frame fence was waited on. In low latency mode,
+        // sleeps until the latest point where building, submitting and rendering
+        // still make the frame period, then latches. The caller polls its input
+        // right after
+        void wait_input_latch();
+        void latch_input();
+        void set_frame_pacing(frame_pacing_t const& pacing);
+
+        // Timings of the most recent frame known to be complete on the GPU
+        [[nodiscard]] auto last_frame_latency() const -> frame_latency_t;
+
+        // Streams every rendered frame to `file` until end_capture(). Encoding
+        // happens on the render thread, disk writes on a dedicated thread.
+        // Draw lists and instance sets are not captured, an error while any exists
+        auto begin_capture(std::filesystem::path const& file) -> orb::result<void>;
+        auto end_capture() -> orb::result<void>;
+
+        // Renders a captured frame in place of this instance's content
+        auto render_replay(replay_frame_t const& frame) -> orb::result<void>;
+
+        // The plot is owned by the instance and drawn on every render
+        auto create_plot(plot_create_info_t&& info) -> orb::result<weak<plot_t>>;
+
+        // To be called from the render thread, not while capturing. The draw
+        // list can then be recorded and published by any one producer thread
+        auto create_draw_list(draw_list_create_info_t const& info) -> orb::result<weak<draw_list_t>>;
+
+        // To be called from the render thread, not while capturing. The set is
+        // culled and drawn on the GPU on every render, over the plots and under
+        // the draw lists
+        auto create_instance_set(instance_set_create_info_t const& info) -> orb::result<weak<instance_set_t>>;
+
+        // Pools are shared by every instance on the same device, so is the usage
+        [[nodiscard]] auto memory_usage() const -> memory_usage_t;
+
+        // Layout of the viewport's widgets, sized by on_resize. The caller
+        // updates it before building the frame's draw data. Like the accessors
+        // below, `viewport` must be below viewport_count()
+        [[nodiscard]] auto layout(ui32 viewport = 0) -> layout_tree_t&;
+
+        // Nodes vertices reference for their transform and opacity, evaluated
+        // on every render. Animating them costs no vertex upload
+        [[nodiscard]] auto animator() -> animator_t&;
+
+        // Clips widgets reference by index, uploaded on every render
+        [[nodiscard]] auto clips() -> clip_stack_t&;
+
+        [[nodiscard]] auto rendered_image(ui32 viewport = 0) const -> VkImage;
+        [[nodiscard]] auto render_finished(ui32 viewport = 0) -> vk::semaphores_view_t&;
 
     private:
         box<gui_renderer_t> m_renderer;
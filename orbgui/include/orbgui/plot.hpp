@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <orb/result.hpp>
+
+#include "orbgui/vertex.hpp"
+
+namespace orb::gui
+{
+    // Widest plot supported, in pixel columns. Bounded by the 16 bits indices
+    // of the shared band index buffer (two vertices per column)
+    static constexpr ui32 max_plot_columns = 8192;
+
+    struct min_max_t
+    {
+        f32 min = std::numeric_limits<f32>::max();
+        f32 max = std::numeric_limits<f32>::lowest();
+
+        void add(f32 value)
+        {
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+        }
+
+        void add(min_max_t const& other)
+        {
+            min = other.min < min ? other.min : min;
+            max = other.max > max ? other.max : max;
+        }
+
+        [[nodiscard]] auto empty() const -> bool { return min > max; }
+    };
+
+    // Append-only sample storage. Samples live in a ring of fixed size chunks,
+    // each one carrying a min/max pyramid so that any retained range can be
+    // reduced in O(log n) whatever its length
+    class series_t
+    {
+    public:
+        static constexpr ui32 chunk_size = 4096;
+        static constexpr ui32 fanout     = 4;
+
+        explicit series_t(ui64 capacity);
+
+        void append(std::span<const f32> samples);
+
+        // Min/max of the samples in [first, last), clipped to the retained range
+        [[nodiscard]] auto range(ui64 first, ui64 last) const -> min_max_t;
+        [[nodiscard]] auto at(ui64 index) const -> f32;
+
+        [[nodiscard]] auto begin_index() const -> ui64 { return m_begin; }
+        [[nodiscard]] auto end_index() const -> ui64 { return m_end; }
+
+    private:
+        struct chunk_t
+        {
+            std::vector<f32>       samples;
+            std::vector<min_max_t> pyramid;
+
+            void reset();
+            void push(ui32 index, f32 value);
+
+            [[nodiscard]] auto query(ui32 lo, ui32 hi) const -> min_max_t;
+        };
+
+        std::vector<chunk_t> m_chunks;
+        ui64                 m_begin = 0;
+        ui64                 m_end   = 0;
+
+        [[nodiscard]] auto chunk(ui64 chunk_index) -> chunk_t&;
+        [[nodiscard]] auto chunk(ui64 chunk_index) const -> chunk_t const&;
+    };
+
+    struct plot_create_info_t
+    {
+        f32                             x;
+        f32                             y;
+        ui32                            width;
+        f32                             height;
+        ui64                            capacity;
+        ui32                            samples_per_column = 0; // 0: fit the whole capacity
+        f32                             y_min;
+        f32                             y_max;
+        std::vector<std::array<f32, 3>> colors; // one series per color
+        ui32                            viewport = 0;
+        ui32                            clip     = 0; // clip_stack_t entry
+        ui32                            node     = 0; // animator_t node, to scroll or zoom without refreshing
+    };
+
+    // Range of the plot vertices that changed since the previous update
+    struct plot_upload_t
+    {
+        ui32 first_vertex;
+        ui32 vertex_count;
+    };
+
+    // Indexed draw into the shared band index buffer
+    struct plot_draw_t
+    {
+        ui32 first_index;
+        ui32 index_count;
+        i32  vertex_offset;
+        ui32 clip;
+    };
+
+    // Sweep plot of streaming series. Each pixel column shows the min/max
+    // envelope of the samples it covers, so a series costs two vertices per
+    // column whatever its sample count. Columns are aligned on absolute sample
+    // indices and written in a ring, so appending only touches the columns the
+    // new samples fall into
+    class plot_t
+    {
+    public:
+        static auto create(plot_create_info_t&& info) -> orb::result<plot_t>;
+
+        void append(ui32 series, std::span<const f32> samples);
+        void set_y_range(f32 y_min, f32 y_max);
+        void set_clip(ui32 clip) { m_info.clip = clip; }
+        void set_node(ui32 node);
+
+        [[nodiscard]] auto series(ui32 index) const -> series_t const& { return m_series[index]; }
+        [[nodiscard]] auto series_count() const -> ui32 { return static_cast<ui32>(m_series.size()); }
+        [[nodiscard]] auto columns() const -> ui32 { return m_info.width; }
+        [[nodiscard]] auto vertex_count() const -> ui32 { return static_cast<ui32>(m_vertices.size()); }
+
+        // Refreshes the columns covered by new samples and the draws. The whole
+        // plot is refreshed when the viewport or the y range changed
+        void update(f32 viewport_width, f32 viewport_height);
+
+        [[nodiscard]] auto vertices() const -> std::span<const vertex_t> { return m_vertices; }
+        [[nodiscard]] auto uploads() const -> std::span<const plot_upload_t> { return m_uploads; }
+        [[nodiscard]] auto draws() const -> std::span<const plot_draw_t> { return m_draws; }
+
+        static void band_indices(std::vector<ui16>& indices);
+
+    private:
+        plot_create_info_t         m_info;
+        ui64                       m_samples_per_column;
+        std::vector<series_t>      m_series;
+        std::vector<ui64>          m_uploaded_end;
+        std::vector<vertex_t>      m_vertices;
+        std::vector<plot_upload_t> m_uploads;
+        std::vector<plot_draw_t>   m_draws;
+        std::array<f32, 2>         m_viewport   = { 0.0f, 0.0f };
+        bool                       m_full_dirty = true;
+
+        explicit plot_t(plot_create_info_t&& info);
+
+        void write_column(ui32 series, ui64 column);
+        void push_slot_ranges(ui32 series, ui64 first_column, ui64 last_column, bool upload);
+    };
+} // namespace orb::gui
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include "orbgui/capture.hpp"
+#include "orbgui/orbgui.hpp"
+
+namespace orb::gui
+{
+    class plot_t;
+    struct plot_create_info_t;
+
+    // Single producer, single consumer message ring in named shared memory
+    class shm_ring_t
+    {
+    public:
+        ~shm_ring_t();
+
+        shm_ring_t(shm_ring_t const&)                        = delete;
+        shm_ring_t(shm_ring_t&&) noexcept                    = default;
+        auto operator=(shm_ring_t const&) -> shm_ring_t&     = delete;
+        auto operator=(shm_ring_t&&) noexcept -> shm_ring_t& = default;
+
+        // The producer creates the ring, the consumer opens it
+        static auto create(std::string const& name, ui64 capacity) -> orb::result<shm_ring_t>;
+        static auto open(std::string const& name) -> orb::result<shm_ring_t>;
+
+        // False when the ring has no room left for the message. Messages over
+        // half the capacity never fit, so an empty ring always takes the others
+        [[nodiscard]] auto push(std::span<const std::byte> message) -> bool;
+
+        // False when the ring is empty, an error when the producer left
+        // records that do not fit the ring
+        [[nodiscard]] auto pop(std::vector<std::byte>& message) -> orb::result<bool>;
+
+        [[nodiscard]] auto capacity() const -> ui64;
+
+    private:
+        struct mapping_t;
+
+        box<mapping_t> m_mapping;
+
+        explicit shm_ring_t(box<mapping_t> mapping);
+    };
+
+    // Remote message layout: a remote_frame_header_t followed by ops, each
+    // one a remote_op_header_t and its payload padded to 8 bytes
+    enum class remote_op : ui32
+    {
+        buffer_create, // capture_buffer_create_t, resets the buffer to zeros (band indices to their table)
+        buffer_delta,  // remote_delta_t, then the encoded bytes
+        pass,          // capture_viewport_t, then capture_draw_t draws
+        repeat_pass,   // ui32 viewport: same draws as the previous frame
+    };
+
+    static constexpr ui32 remote_keyframe = 1;
+
+    // Largest buffer a remote frame may declare, the receiver shadows each one
+    static constexpr ui64 remote_max_buffer_size = 256ull << 20;
+
+    struct remote_frame_header_t
+    {
+        ui32 magic;
+        ui32 flags;
+        ui64 frame;
+    };
+
+    struct remote_op_header_t
+    {
+        remote_op type;
+        ui32      size;
+    };
+
+    // Changed range of a buffer, XORed against its previous content and
+    // zero-run encoded
+    struct remote_delta_t
+    {
+        ui32 buffer;
+        ui32 encoded_size;
+        ui64 offset;
+        ui64 size;
+    };
+
+    auto encode_delta(std::span<const std::byte> current,
+                      std::span<const std::byte> previous,
+                      std::vector<std::byte>&    out) -> void;
+    auto apply_delta(std::span<const std::byte> encoded, std::span<std::byte> content) -> orb::result<void>;
+
+    struct remote_sender_create_info_t
+    {
+        std::string                         channel;
+        ui64                                ring_size = 64ull << 20;
+        std::vector<viewport_create_info_t> viewports;
+    };
+
+    // GPU-less GUI host: owns the plots and publishes each frame to a
+    // remote_receiver_t as a delta against the previous one
+    class remote_sender_t
+    {
+    public:
+        ~remote_sender_t();
+
+        remote_sender_t(remote_sender_t const&)                        = delete;
+        remote_sender_t(remote_sender_t&&) noexcept                    = default;
+        auto operator=(remote_sender_t const&) -> remote_sender_t&     = delete;
+        auto operator=(remote_sender_t&&) noexcept -> remote_sender_t& = default;
+
+        static auto create(remote_sender_create_info_t&& info) -> orb::result<remote_sender_t>;
+
+        // Remote frames carry no clips, clipped plots are an error
+        auto create_plot(plot_create_info_t&& info) -> orb::result<weak<plot_t>>;
+
+        // Returns false when the receiver lagged and the frame was dropped,
+        // the next frame is then sent as a keyframe. An error when a plot was
+        // given a clip since its creation
+        auto publish() -> orb::result<bool>;
+
+        [[nodiscard]] auto bytes_sent() const -> ui64;
+        [[nodiscard]] auto frames_dropped() const -> ui64;
+
+    private:
+        struct state_t;
+
+        box<state_t> m_state;
+
+        explicit remote_sender_t(box<state_t> state);
+    };
+
+    // Rebuilds the frames of a remote_sender_t for instance_t::render_replay()
+    class remote_receiver_t
+    {
+    public:
+        ~remote_receiver_t();
+
+        remote_receiver_t(remote_receiver_t const&)                        = delete;
+        remote_receiver_t(remote_receiver_t&&) noexcept                    = default;
+        auto operator=(remote_receiver_t const&) -> remote_receiver_t&     = delete;
+        auto operator=(remote_receiver_t&&) noexcept -> remote_receiver_t& = default;
+
+        static auto open(std::string const& channel) -> orb::result<remote_receiver_t>;
+
+        // Applies every pending message. `frame` gets the uploads since the
+        // previous poll and the current draws, returns false when none arrived
+        auto poll(replay_frame_t& frame) -> orb::result<bool>;
+
+        [[nodiscard]] auto bytes_received() const -> ui64;
+
+    private:
+        struct state_t;
+
+        box<state_t> m_state;
+
+        explicit remote_receiver_t(box<state_t> state);
+    };
+} // namespace orb::gui
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <array>
+
+#include <orb/result.hpp>
+
+namespace orb::gui
+{
+    struct vertex_t
+    {
+        std::array<f32, 2> pos;
+        std::array<f32, 3> col;
+        ui32               node = 0; // animator_t node whose parameters apply
+    };
+} // namespace orb::gui
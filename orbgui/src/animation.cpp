@@ -0,0 +1,213 @@
+#include "orbgui/animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace orb::gui
+{
+    static constexpr std::array<f32, node_channel_count> identity_values = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+
+    static auto ease(easing curve, f32 t) -> f32
+    {
+        switch (curve)
+        {
+            case easing::linear: return t;
+            case easing::ease_in: return t * t * t;
+            case easing::ease_out: return 1.0f - (1.0f - t) * (1.0f - t) * (1.0f - t);
+            case easing::ease_in_out:
+                return t < 0.5f ? 4.0f * t * t * t : 1.0f - 4.0f * (1.0f - t) * (1.0f - t) * (1.0f - t);
+        }
+
+        return t;
+    }
+
+    animator_t::animator_t()
+    {
+        m_nodes.push_back({ .values = identity_values });
+        m_params.emplace_back();
+    }
+
+    auto animator_t::create_node() -> ui32
+    {
+        if (!m_free.empty())
+        {
+            const ui32 node = m_free.back();
+            m_free.pop_back();
+
+            m_nodes[node] = { .values = identity_values };
+            m_params[node] = {};
+
+            return node;
+        }
+
+        m_nodes.push_back({ .values = identity_values });
+        m_params.emplace_back();
+
+        return static_cast<ui32>(m_nodes.size() - 1);
+    }
+
+    auto animator_t::writable(ui32 node) const -> bool
+    {
+        return node != root_node && node < m_nodes.size() && m_nodes[node].alive;
+    }
+
+    void animator_t::destroy_node(ui32 node)
+    {
+        if (!this->writable(node))
+        {
+            return;
+        }
+
+        std::erase_if(m_curves, [node](curve_t const& curve) { return curve.node == node; });
+
+        // Vertices still pointing here are drawn untransformed
+        m_nodes[node] = { .values = identity_values, .alive = false };
+        m_params[node] = {};
+        m_free.push_back(node);
+    }
+
+    void animator_t::set(ui32 node, node_channel channel, f32 value)
+    {
+        if (!this->writable(node))
+        {
+            return;
+        }
+
+        this->cancel(node, channel);
+
+        m_nodes[node].values[static_cast<ui32>(channel)] = value;
+        this->touch(node);
+    }
+
+    void animator_t::set_pivot(ui32 node, f32 x, f32 y)
+    {
+        if (!this->writable(node))
+        {
+            return;
+        }
+
+        m_nodes[node].pivot = { x, y };
+        this->touch(node);
+    }
+
+    void animator_t::animate(ui32 node, node_channel channel, f32 target, f64 duration_ms, easing ease)
+    {
+        if (!this->writable(node))
+        {
+            return;
+        }
+
+        this->cancel(node, channel);
+
+        m_curves.push_back({
+            .node     = node,
+            .channel  = channel,
+            .from     = m_nodes[node].values[static_cast<ui32>(channel)],
+            .to       = target,
+            .start    = -1.0,
+            .duration = duration_ms,
+            .ease     = ease,
+        });
+    }
+
+    auto animator_t::value(ui32 node, node_channel channel) const -> f32
+    {
+        // Unknown and destroyed nodes read as the identity
+        if (node >= m_nodes.size() || !m_nodes[node].alive)
+        {
+            return identity_values[static_cast<ui32>(channel)];
+        }
+
+        return m_nodes[node].values[static_cast<ui32>(channel)];
+    }
+
+    void animator_t::evaluate(f64 time_ms)
+    {
+        for (size_t i = 0; i < m_curves.size();)
+        {
+            auto& curve = m_curves[i];
+
+            if (curve.start < 0.0)
+            {
+                curve.start = time_ms;
+            }
+
+            const f64 t = curve.duration > 0.0 ? std::clamp((time_ms - curve.start) / curve.duration, 0.0, 1.0) : 1.0;
+
+            m_nodes[curve.node].values[static_cast<ui32>(curve.channel)]
+                = curve.from + (curve.to - curve.from) * ease(curve.ease, static_cast<f32>(t));
+            this->touch(curve.node);
+
+            if (t < 1.0)
+            {
+                ++i;
+                continue;
+            }
+
+            // Finished, the order of the others does not matter
+            curve = m_curves.back();
+            m_curves.pop_back();
+        }
+
+        for (const ui32 node : m_dirty)
+        {
+            this->refresh(node);
+        }
+
+        m_dirty.clear();
+    }
+
+    void animator_t::cancel(ui32 node, node_channel channel)
+    {
+        const auto it = std::ranges::find_if(m_curves, [&](curve_t const& curve) {
+            return curve.node == node && curve.channel == channel;
+        });
+
+        if (it != m_curves.end())
+        {
+            *it = m_curves.back();
+            m_curves.pop_back();
+        }
+    }
+
+    void animator_t::touch(ui32 node)
+    {
+        if (!m_nodes[node].dirty)
+        {
+            m_nodes[node].dirty = true;
+            m_dirty.push_back(node);
+        }
+    }
+
+    // Scales and rotates around the pivot, then translates
+    void animator_t::refresh(ui32 node)
+    {
+        auto& n = m_nodes[node];
+
+        n.dirty = false;
+
+        if (!n.alive)
+        {
+            return;
+        }
+
+        auto const& v     = n.values;
+        const f32   sx    = v[static_cast<ui32>(node_channel::scale_x)];
+        const f32   sy    = v[static_cast<ui32>(node_channel::scale_y)];
+        const f32   angle = v[static_cast<ui32>(node_channel::rotation)];
+        const f32   c     = std::cos(angle);
+        const f32   s     = std::sin(angle);
+
+        auto& params  = m_params[node];
+        params.linear = { c * sx, s * sx, -s * sy, c * sy };
+
+        const auto [px, py] = n.pivot;
+
+        params.translate = {
+            px + v[static_cast<ui32>(node_channel::translate_x)] - (params.linear[0] * px + params.linear[2] * py),
+            py + v[static_cast<ui32>(node_channel::translate_y)] - (params.linear[1] * px + params.linear[3] * py),
+        };
+
+        params.opacity = v[static_cast<ui32>(node_channel::opacity)];
+    }
+} // namespace orb::gui
@@ -0,0 +1,578 @@
+#include "orbgui/capture.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "orbgui/vertex.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace orb::gui
+{
+    static constexpr auto align_record(size_t size) -> size_t
+    {
+        return (size + 7) & ~static_cast<size_t>(7);
+    }
+
+    // Frames written ahead of the file, end_frame() waits above it
+    static constexpr size_t max_queued_bytes = 64ull << 20;
+
+    struct capture_writer_t::stream_t
+    {
+        std::FILE* file = nullptr;
+
+        // render thread side
+        std::vector<std::byte> current;
+
+        // shared with the writer thread
+        std::mutex                          mutex;
+        std::condition_variable             cv;
+        std::condition_variable             drained;
+        std::vector<std::vector<std::byte>> pending;
+        std::vector<std::vector<std::byte>> recycled;
+        size_t                              queued = 0; // bytes pending or being written
+        ui64                                stalls = 0;
+        bool                                stop   = false;
+        bool                                failed = false;
+
+        std::thread thread;
+
+        void append(void const* data, size_t size)
+        {
+            auto const* bytes = static_cast<std::byte const*>(data);
+            this->current.insert(this->current.end(), bytes, bytes + size);
+        }
+
+        void record(capture_record type, std::span<const std::byte> payload, std::span<const std::byte> extra = {})
+        {
+            const size_t size   = payload.size() + extra.size();
+            const size_t padded = align_record(size);
+
+            const capture_record_header_t header {
+                .type = type,
+                .size = static_cast<ui32>(padded),
+            };
+
+            this->append(&header, sizeof(header));
+            this->current.insert(this->current.end(), payload.begin(), payload.end());
+            this->current.insert(this->current.end(), extra.begin(), extra.end());
+            this->current.resize(this->current.size() + padded - size, std::byte { 0 });
+        }
+
+        template <typename T>
+        void record(capture_record type, T const& payload, std::span<const std::byte> extra = {})
+        {
+            this->record(type, std::as_bytes(std::span { &payload, 1 }), extra);
+        }
+
+        void run()
+        {
+            std::vector<std::vector<std::byte>> batch;
+
+            while (true)
+            {
+                {
+                    std::unique_lock lock(this->mutex);
+                    this->cv.wait(lock, [&] { return this->stop || !this->pending.empty(); });
+
+                    if (this->pending.empty())
+                    {
+                        return;
+                    }
+
+                    std::swap(batch, this->pending);
+                }
+
+                bool ok = true;
+
+                for (auto const& frame : batch)
+                {
+                    ok = ok && std::fwrite(frame.data(), 1, frame.size(), this->file) == frame.size();
+                }
+
+                std::scoped_lock lock(this->mutex);
+
+                this->failed = this->failed || !ok;
+
+                for (auto& frame : batch)
+                {
+                    this->queued -= frame.size();
+                    frame.clear();
+                    this->recycled.push_back(std::move(frame));
+                }
+
+                batch.clear();
+                this->drained.notify_one();
+            }
+        }
+    };
+
+    capture_writer_t::~capture_writer_t()
+    {
+        if (m_stream)
+        {
+            this->finish();
+        }
+    }
+
+    capture_writer_t::capture_writer_t(box<stream_t> stream)
+        : m_stream(std::move(stream))
+    {
+    }
+
+    auto capture_writer_t::create(std::filesystem::path const& file) -> orb::result<capture_writer_t>
+    {
+        auto stream = make_box<stream_t>();
+
+        stream->file = std::fopen(file.string().c_str(), "wb");
+
+        if (stream->file == nullptr)
+        {
+            return orb::error_t { "Could not open capture file {}", file.string() };
+        }
+
+        const capture_header_t header {
+            .magic       = capture_magic,
+            .version     = capture_version,
+            .vertex_size = sizeof(vertex_t),
+        };
+
+        if (std::fwrite(&header, sizeof(header), 1, stream->file) != 1)
+        {
+            std::fclose(stream->file);
+            return orb::error_t { "Could not write capture header to {}", file.string() };
+        }
+
+        auto* s        = stream.getmut();
+        stream->thread = std::thread([s] { s->run(); });
+
+        return capture_writer_t { std::move(stream) };
+    }
+
+    void capture_writer_t::begin_frame(ui64 frame)
+    {
+        const capture_frame_begin_t payload { .frame = frame };
+        m_stream->record(capture_record::frame_begin, payload);
+    }
+
+    void capture_writer_t::create_buffer(ui32 buffer, capture_buffer_usage usage, ui64 size)
+    {
+        const capture_buffer_create_t payload {
+            .buffer = buffer,
+            .usage  = usage,
+            .size   = size,
+        };
+
+        m_stream->record(capture_record::buffer_create, payload);
+    }
+
+    void capture_writer_t::upload(ui32 buffer, ui64 offset, std::span<const std::byte> data)
+    {
+        const capture_buffer_upload_t payload {
+            .buffer   = buffer,
+            .reserved = 0,
+            .offset   = offset,
+            .size     = data.size(),
+        };
+
+        m_stream->record(capture_record::buffer_upload, payload, data);
+    }
+
+    void capture_writer_t::viewport(capture_viewport_t const& viewport)
+    {
+        m_stream->record(capture_record::viewport_begin, viewport);
+    }
+
+    void capture_writer_t::draw(capture_draw_t const& draw)
+    {
+        m_stream->record(capture_record::draw, draw);
+    }
+
+    void capture_writer_t::clips(std::span<const clip_entry_t> entries)
+    {
+        m_stream->record(capture_record::clip_entries, std::as_bytes(entries));
+    }
+
+    void capture_writer_t::nodes(std::span<const node_params_t> params)
+    {
+        m_stream->record(capture_record::node_params, std::as_bytes(params));
+    }
+
+    void capture_writer_t::end_frame()
+    {
+        auto& s = *m_stream;
+
+        s.record(capture_record::frame_end, {});
+
+        std::unique_lock lock(s.mutex);
+
+        // Dropping a frame would lose its uploads, so a slow disk stalls the
+        // render thread instead of growing the queue without bound
+        if (s.queued != 0 && s.queued + s.current.size() > max_queued_bytes)
+        {
+            s.stalls++;
+            s.drained.wait(lock, [&] { return s.queued == 0 || s.queued + s.current.size() <= max_queued_bytes; });
+        }
+
+        s.queued += s.current.size();
+        s.pending.push_back(std::move(s.current));
+
+        if (s.recycled.empty())
+        {
+            s.current = {};
+        }
+        else
+        {
+            s.current = std::move(s.recycled.back());
+            s.recycled.pop_back();
+        }
+
+        s.cv.notify_one();
+    }
+
+    auto capture_writer_t::stalls() const -> ui64
+    {
+        std::scoped_lock lock(m_stream->mutex);
+        return m_stream->stalls;
+    }
+
+    auto capture_writer_t::finish() -> orb::result<void>
+    {
+        auto& s = *m_stream;
+
+        if (s.file == nullptr)
+        {
+            return {};
+        }
+
+        {
+            std::scoped_lock lock(s.mutex);
+            s.stop = true;
+            s.cv.notify_one();
+        }
+
+        s.thread.join();
+
+        // Frames left open are dropped, a capture only holds complete frames
+        const bool closed = std::fclose(s.file) == 0;
+        s.file            = nullptr;
+
+        if (s.failed || !closed)
+        {
+            return orb::error_t { "Failed to write capture" };
+        }
+
+        return {};
+    }
+
+    auto next_capture_record(std::span<const std::byte>& records) -> orb::result<capture_record_view_t>
+    {
+        capture_record_header_t header;
+
+        if (records.size() < sizeof(header))
+        {
+            return orb::error_t { "Truncated capture record header, {} bytes left", records.size() };
+        }
+
+        std::memcpy(&header, records.data(), sizeof(header));
+
+        if (records.size() - sizeof(header) < header.size)
+        {
+            return orb::error_t { "Capture record of {} bytes overruns the {} bytes left", header.size, records.size() - sizeof(header) };
+        }
+
+        capture_record_view_t view {
+            .type    = header.type,
+            .payload = records.subspan(sizeof(header), header.size),
+        };
+
+        records = records.subspan(sizeof(header) + header.size);
+
+        return view;
+    }
+
+    struct capture_file_t::mapping_t
+    {
+        std::byte const* data = nullptr;
+        size_t           size = 0;
+
+#ifdef _WIN32
+        HANDLE file    = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+        mapping_t() = default;
+
+        mapping_t(mapping_t const&)                    = delete;
+        mapping_t(mapping_t&&)                         = delete;
+        auto operator=(mapping_t const&) -> mapping_t& = delete;
+        auto operator=(mapping_t&&) -> mapping_t&      = delete;
+
+        ~mapping_t()
+        {
+#ifdef _WIN32
+            if (this->data != nullptr) UnmapViewOfFile(this->data);
+            if (this->mapping != nullptr) CloseHandle(this->mapping);
+            if (this->file != INVALID_HANDLE_VALUE) CloseHandle(this->file);
+#else
+            if (this->data != nullptr) munmap(const_cast<std::byte*>(this->data), this->size);
+#endif
+        }
+
+        auto map(std::filesystem::path const& path) -> orb::result<void>
+        {
+#ifdef _WIN32
+            this->file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            if (this->file == INVALID_HANDLE_VALUE)
+            {
+                return orb::error_t { "Could not open capture file {}", path.string() };
+            }
+
+            LARGE_INTEGER size;
+            GetFileSizeEx(this->file, &size);
+            this->size = static_cast<size_t>(size.QuadPart);
+
+            this->mapping = CreateFileMappingW(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (this->mapping == nullptr)
+            {
+                return orb::error_t { "Could not map capture file {}", path.string() };
+            }
+
+            this->data = static_cast<std::byte const*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0)
+            {
+                return orb::error_t { "Could not open capture file {}", path.string() };
+            }
+
+            struct stat st = {};
+            fstat(fd, &st);
+            this->size = static_cast<size_t>(st.st_size);
+
+            void* data = this->size > 0 ? mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+            ::close(fd);
+
+            if (data != MAP_FAILED)
+            {
+                this->data = static_cast<std::byte const*>(data);
+            }
+#endif
+
+            if (this->data == nullptr)
+            {
+                return orb::error_t { "Could not map capture file {}", path.string() };
+            }
+
+            return {};
+        }
+    };
+
+    capture_file_t::~capture_file_t() = default;
+
+    capture_file_t::capture_file_t(box<mapping_t> mapping)
+        : m_mapping(std::move(mapping))
+    {
+    }
+
+    auto capture_file_t::open(std::filesystem::path const& file) -> orb::result<capture_file_t>
+    {
+        auto mapping = make_box<mapping_t>();
+
+        if (auto res = mapping->map(file); !res)
+        {
+            return res.error();
+        }
+
+        const std::span<const std::byte> bytes { mapping->data, mapping->size };
+
+        capture_header_t header;
+
+        if (bytes.size() < sizeof(header))
+        {
+            return orb::error_t { "Truncated capture header" };
+        }
+
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        if (header.magic != capture_magic)
+        {
+            return orb::error_t { "Not a capture file: {}", file.string() };
+        }
+
+        if (header.version != capture_version)
+        {
+            return orb::error_t { "Unsupported capture version {}, expected {}", header.version, capture_version };
+        }
+
+        if (header.vertex_size != sizeof(vertex_t))
+        {
+            return orb::error_t { "Capture vertex size {} does not match {}", header.vertex_size, sizeof(vertex_t) };
+        }
+
+        capture_file_t capture { std::move(mapping) };
+
+        // Index the complete frames, a truncated trailing frame is ignored
+        auto   records     = bytes.subspan(sizeof(header));
+        size_t frame_begin = 0;
+        ui64   frame       = 0;
+        bool   in_frame    = false;
+
+        while (!records.empty())
+        {
+            const size_t offset = bytes.size() - records.size();
+
+            auto next = next_capture_record(records);
+
+            if (!next)
+            {
+                break;
+            }
+
+            auto const& record = next.unwrap();
+
+            if (record.type == capture_record::frame_begin)
+            {
+                if (!record.holds<capture_frame_begin_t>())
+                {
+                    return orb::error_t { "Truncated frame begin at offset {}", offset };
+                }
+
+                frame_begin = offset;
+                frame       = record.as<capture_frame_begin_t>().frame;
+                in_frame    = true;
+            }
+            else if (record.type == capture_record::frame_end && in_frame)
+            {
+                const size_t frame_end = bytes.size() - records.size();
+
+                capture.m_frames.push_back({
+                    .frame   = frame,
+                    .records = bytes.subspan(frame_begin, frame_end - frame_begin),
+                });
+
+                in_frame = false;
+            }
+        }
+
+        return capture;
+    }
+
+    void replay_frame_t::clear()
+    {
+        this->frame = 0;
+        this->creates.clear();
+        this->uploads.clear();
+        this->passes.clear();
+        this->clips = {};
+        this->nodes = {};
+    }
+
+    auto decode_capture_frame(capture_frame_t const& frame, replay_frame_t& out) -> orb::result<void>
+    {
+        out.clear();
+        out.frame = frame.frame;
+
+        auto records = frame.records;
+
+        // Lengths come from the file, every payload is checked before use
+        auto truncated = [&](capture_record type) -> orb::error_t {
+            return orb::error_t { "Truncated capture record {} in frame {}", static_cast<ui32>(type), frame.frame };
+        };
+
+        while (!records.empty())
+        {
+            auto next = next_capture_record(records);
+
+            if (!next)
+            {
+                return next.error();
+            }
+
+            auto const& record = next.unwrap();
+
+            switch (record.type)
+            {
+                case capture_record::frame_begin:
+                case capture_record::frame_end: break;
+                case capture_record::buffer_create:
+                    if (!record.holds<capture_buffer_create_t>())
+                    {
+                        return truncated(record.type);
+                    }
+
+                    out.creates.push_back(record.as<capture_buffer_create_t>());
+                    break;
+                case capture_record::buffer_upload:
+                {
+                    if (!record.holds<capture_buffer_upload_t>())
+                    {
+                        return truncated(record.type);
+                    }
+
+                    auto const& upload = record.as<capture_buffer_upload_t>();
+
+                    if (upload.size > record.payload.size() - sizeof(upload))
+                    {
+                        return truncated(record.type);
+                    }
+
+                    out.uploads.push_back({
+                        .buffer = upload.buffer,
+                        .offset = upload.offset,
+                        .data   = record.payload.subspan(sizeof(upload), upload.size),
+                    });
+                    break;
+                }
+                case capture_record::viewport_begin:
+                    if (!record.holds<capture_viewport_t>())
+                    {
+                        return truncated(record.type);
+                    }
+
+                    out.passes.push_back({ .viewport = record.as<capture_viewport_t>(), .draws = {} });
+                    break;
+                case capture_record::draw:
+                    if (out.passes.empty())
+                    {
+                        return orb::error_t { "Draw outside of a viewport in frame {}", frame.frame };
+                    }
+
+                    if (!record.holds<capture_draw_t>())
+                    {
+                        return truncated(record.type);
+                    }
+
+                    out.passes.back().draws.push_back(record.as<capture_draw_t>());
+                    break;
+                case capture_record::clip_entries:
+                    out.clips = { reinterpret_cast<clip_entry_t const*>(record.payload.data()),
+                                  record.payload.size() / sizeof(clip_entry_t) };
+                    break;
+                case capture_record::node_params:
+                    out.nodes = { reinterpret_cast<node_params_t const*>(record.payload.data()),
+                                  record.payload.size() / sizeof(node_params_t) };
+                    break;
+                default:
+                    return orb::error_t { "Unknown capture record {} in frame {}", static_cast<ui32>(record.type), frame.frame };
+            }
+        }
+
+        return {};
+    }
+} // namespace orb::gui
@@ -0,0 +1,78 @@
+#include "orbgui/clip.hpp"
+
+#include <algorithm>
+
+namespace orb::gui
+{
+    // Wide enough for any viewport, small enough to stay exact in the shaders
+    static constexpr f32 unbounded = 1e7f;
+
+    clip_stack_t::clip_stack_t()
+    {
+        this->reset();
+    }
+
+    void clip_stack_t::reset()
+    {
+        m_entries.clear();
+        m_stack.clear();
+
+        m_entries.push_back({
+            .rect     = { -unbounded, -unbounded, unbounded, unbounded },
+            .bounds   = { -unbounded, -unbounded, unbounded, unbounded },
+            .radius   = 0.0f,
+            .reserved = 0.0f,
+        });
+
+        m_stack.push_back(no_clip);
+    }
+
+    auto clip_stack_t::push(clip_rect_t const& rect) -> ui32
+    {
+        auto const& parent = m_entries[this->current()].bounds;
+
+        const std::array<f32, 4> own = { rect.x, rect.y, rect.x + rect.width, rect.y + rect.height };
+
+        std::array<f32, 4> bounds = {
+            std::max(own[0], parent[0]),
+            std::max(own[1], parent[1]),
+            std::min(own[2], parent[2]),
+            std::min(own[3], parent[3]),
+        };
+
+        // An empty intersection still gets an entry, it just clips everything
+        bounds[2] = std::max(bounds[2], bounds[0]);
+        bounds[3] = std::max(bounds[3], bounds[1]);
+
+        const f32 radius = std::clamp(rect.radius, 0.0f, std::min(rect.width, rect.height) * 0.5f);
+
+        const clip_entry_t entry {
+            .rect     = radius > 0.0f ? own : bounds,
+            .bounds   = bounds,
+            .radius   = radius,
+            .reserved = 0.0f,
+        };
+
+        // Siblings with the same clip, such as table cells of one row, share it
+        auto const& last = m_entries.back();
+
+        const bool same = last.rect == entry.rect && last.bounds == entry.bounds && last.radius == entry.radius;
+
+        if (!same)
+        {
+            m_entries.push_back(entry);
+        }
+
+        m_stack.push_back(static_cast<ui32>(m_entries.size() - 1));
+
+        return m_stack.back();
+    }
+
+    void clip_stack_t::pop()
+    {
+        if (m_stack.size() > 1)
+        {
+            m_stack.pop_back();
+        }
+    }
+} // namespace orb::gui
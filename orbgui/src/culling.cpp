@@ -0,0 +1,461 @@
+#include "culling.hpp"
+
+#include <algorithm>
+
+#include <orb/files.hpp>
+
+#include "orbgui/clip.hpp"
+#include "orbgui/instances.hpp"
+
+namespace orb::gui
+{
+    static constexpr ui32 min_clip_capacity = 64;
+
+    // Bindings of the set layout, shared by cull.comp.glsl and instance.vs.glsl
+    enum cull_binding : ui32
+    {
+        cull_binding_items,
+        cull_binding_visible,
+        cull_binding_commands,
+        cull_binding_counts,
+        cull_binding_clips,
+        cull_binding_count,
+    };
+
+    gpu_culler_t::~gpu_culler_t()
+    {
+        if (m_device == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        vkDestroyPipeline(m_device, m_draw_pipeline, nullptr);
+        vkDestroyPipeline(m_device, m_cull_pipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_layout, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_set_layout, nullptr);
+    }
+
+    auto gpu_culler_t::create(weak<vk::device_t>           device,
+                              memory_pools_t&              pools,
+                              VkRenderPass                 render_pass,
+                              VkShaderModule               fragment_shader,
+                              std::filesystem::path const& shader_dir,
+                              ui32                         frames,
+                              bool                         draw_indirect_count) -> orb::result<box<gpu_culler_t>>
+    {
+        auto culler = make_box<gpu_culler_t>();
+
+        culler->m_device              = device->handle;
+        culler->m_pools               = &pools;
+        culler->m_frames              = frames;
+        culler->m_draw_indirect_count = draw_indirect_count;
+
+        const path cs_path { (shader_dir / "cull.comp.glsl").string() };
+        const path vs_path { (shader_dir / "instance.vs.glsl").string() };
+
+        vk::spirv_compiler_t compiler;
+        compiler.option_target_env(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2)
+            .option_generate_debug_info()
+            .option_target_spirv(shaderc_spirv_version_1_3)
+            .option_source_language(shaderc_source_language_glsl)
+            .option_optimization_level(shaderc_optimization_level_performance)
+            .option_warnings_as_errors();
+
+        auto cs_content = cs_path.read_file();
+        auto vs_content = vs_path.read_file();
+
+        if (!cs_content || !vs_content)
+        {
+            return orb::error_t { "Cannot read the culling shaders from {}", shader_dir.string() };
+        }
+
+        auto cs_res = vk::shader_module_builder_t::prepare(device, &compiler)
+                          .unwrap()
+                          .kind(vk::shader_kind::glsl_compute)
+                          .entry_point("main")
+                          .content(std::move(cs_content.unwrap()))
+                          .build();
+
+        if (!cs_res)
+        {
+            return cs_res.error();
+        }
+
+        auto vs_res = vk::shader_module_builder_t::prepare(device, &compiler)
+                          .unwrap()
+                          .kind(vk::shader_kind::glsl_vertex)
+                          .entry_point("main")
+                          .content(std::move(vs_content.unwrap()))
+                          .build();
+
+        if (!vs_res)
+        {
+            return vs_res.error();
+        }
+
+        culler->m_cull_shader   = std::move(cs_res.unwrap());
+        culler->m_vertex_shader = std::move(vs_res.unwrap());
+
+        if (auto res = culler->create_pipelines(render_pass, fragment_shader); !res)
+        {
+            return res.error();
+        }
+
+        if (auto res = culler->reserve_clips(min_clip_capacity); !res)
+        {
+            return res.error();
+        }
+
+        return culler;
+    }
+
+    auto gpu_culler_t::create_pipelines(VkRenderPass render_pass, VkShaderModule fragment_shader) -> orb::result<void>
+    {
+        std::array<VkDescriptorSetLayoutBinding, cull_binding_count> bindings {};
+
+        for (ui32 i = 0; i < cull_binding_count; ++i)
+        {
+            bindings[i] = {
+                .binding         = i,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+            };
+        }
+
+        const VkDescriptorSetLayoutCreateInfo set_layout_info {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = static_cast<ui32>(bindings.size()),
+            .pBindings    = bindings.data(),
+        };
+
+        if (auto res = vkCreateDescriptorSetLayout(m_device, &set_layout_info, nullptr, &m_set_layout); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Culling descriptor set layout creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const VkPushConstantRange constants {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+            .offset     = 0,
+            .size       = sizeof(cull_constants_t),
+        };
+
+        const VkPipelineLayoutCreateInfo layout_info {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = 1,
+            .pSetLayouts            = &m_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &constants,
+        };
+
+        if (auto res = vkCreatePipelineLayout(m_device, &layout_info, nullptr, &m_layout); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Culling pipeline layout creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const VkComputePipelineCreateInfo cull_info {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = m_cull_shader.handle,
+                .pName  = "main",
+            },
+            .layout = m_layout,
+        };
+
+        if (auto res = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &cull_info, nullptr, &m_cull_pipeline); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Culling pipeline creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        // Survivors are drawn as instances of the quad, their corners and
+        // clips fetched in the vertex shader, so there is no vertex input
+        const std::array<VkPipelineShaderStageCreateInfo, 2> stages = { {
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = m_vertex_shader.handle,
+                .pName  = "main",
+            },
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module = fragment_shader,
+                .pName  = "main",
+            },
+        } };
+
+        const VkPipelineVertexInputStateCreateInfo vertex_input {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        };
+
+        const VkPipelineInputAssemblyStateCreateInfo input_assembly {
+            .sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        };
+
+        const VkPipelineViewportStateCreateInfo viewport_state {
+            .sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .viewportCount = 1,
+            .scissorCount  = 1,
+        };
+
+        const VkPipelineRasterizationStateCreateInfo rasterizer {
+            .sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .polygonMode = VK_POLYGON_MODE_FILL,
+            .cullMode    = VK_CULL_MODE_NONE,
+            .frontFace   = VK_FRONT_FACE_CLOCKWISE,
+            .lineWidth   = 1.0f,
+        };
+
+        const VkPipelineMultisampleStateCreateInfo multisample {
+            .sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        };
+
+        const VkPipelineColorBlendAttachmentState blend_attachment {
+            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+        };
+
+        const VkPipelineColorBlendStateCreateInfo blending {
+            .sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+            .attachmentCount = 1,
+            .pAttachments    = &blend_attachment,
+        };
+
+        const std::array<VkDynamicState, 2> dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+        const VkPipelineDynamicStateCreateInfo dynamic {
+            .sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .dynamicStateCount = static_cast<ui32>(dynamic_states.size()),
+            .pDynamicStates    = dynamic_states.data(),
+        };
+
+        const VkGraphicsPipelineCreateInfo draw_info {
+            .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .stageCount          = static_cast<ui32>(stages.size()),
+            .pStages             = stages.data(),
+            .pVertexInputState   = &vertex_input,
+            .pInputAssemblyState = &input_assembly,
+            .pViewportState      = &viewport_state,
+            .pRasterizationState = &rasterizer,
+            .pMultisampleState   = &multisample,
+            .pColorBlendState    = &blending,
+            .pDynamicState       = &dynamic,
+            .layout              = m_layout,
+            .renderPass          = render_pass,
+            .subpass             = 0,
+        };
+
+        if (auto res = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &draw_info, nullptr, &m_draw_pipeline); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Instance pipeline creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        return {};
+    }
+
+    auto gpu_culler_t::create_set(ui32 capacity) -> orb::result<cull_set_t>
+    {
+        cull_set_t set;
+
+        set.groups = std::max((capacity + cull_group_size - 1) / cull_group_size, 1u);
+
+        const VkDeviceSize visible_size = static_cast<VkDeviceSize>(set.groups) * cull_group_size * sizeof(ui32) * m_frames;
+        const VkDeviceSize command_size = static_cast<VkDeviceSize>(set.groups) * sizeof(VkDrawIndexedIndirectCommand) * m_frames;
+
+        auto items = gpu_buffer_t::create(*m_pools,
+                                          std::max<VkDeviceSize>(capacity, 1) * sizeof(instance_item_t),
+                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        auto visible = gpu_buffer_t::create(*m_pools,
+                                            visible_size,
+                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        auto commands = gpu_buffer_t::create(*m_pools,
+                                             command_size,
+                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        auto counts = gpu_buffer_t::create(*m_pools,
+                                           sizeof(ui32) * m_frames,
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (!items) return items.error();
+        if (!visible) return visible.error();
+        if (!commands) return commands.error();
+        if (!counts) return counts.error();
+
+        set.items    = std::move(items.unwrap());
+        set.visible  = std::move(visible.unwrap());
+        set.commands = std::move(commands.unwrap());
+        set.counts   = std::move(counts.unwrap());
+
+        const VkDescriptorPoolSize pool_size {
+            .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = cull_binding_count,
+        };
+
+        const VkDescriptorPoolCreateInfo pool_info {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets       = 1,
+            .poolSizeCount = 1,
+            .pPoolSizes    = &pool_size,
+        };
+
+        if (auto res = vkCreateDescriptorPool(m_device, &pool_info, nullptr, &set.pool); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Culling descriptor pool creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const VkDescriptorSetAllocateInfo alloc_info {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = set.pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &m_set_layout,
+        };
+
+        if (auto res = vkAllocateDescriptorSets(m_device, &alloc_info, &set.set); res != VK_SUCCESS)
+        {
+            this->destroy_set(set);
+            return orb::error_t { "Culling descriptor set allocation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const std::array<VkDescriptorBufferInfo, cull_binding_clips> buffers = { {
+            { .buffer = set.items.handle(), .offset = 0, .range = VK_WHOLE_SIZE },
+            { .buffer = set.visible.handle(), .offset = 0, .range = VK_WHOLE_SIZE },
+            { .buffer = set.commands.handle(), .offset = 0, .range = VK_WHOLE_SIZE },
+            { .buffer = set.counts.handle(), .offset = 0, .range = VK_WHOLE_SIZE },
+        } };
+
+        std::array<VkWriteDescriptorSet, cull_binding_clips> writes {};
+
+        for (ui32 i = 0; i < writes.size(); ++i)
+        {
+            writes[i] = {
+                .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet          = set.set,
+                .dstBinding      = i,
+                .descriptorCount = 1,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo     = &buffers[i],
+            };
+        }
+
+        vkUpdateDescriptorSets(m_device, static_cast<ui32>(writes.size()), writes.data(), 0, nullptr);
+        this->bind_clips(set);
+
+        return set;
+    }
+
+    void gpu_culler_t::destroy_set(cull_set_t& set)
+    {
+        if (set.pool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, set.pool, nullptr);
+        }
+
+        set.pool = VK_NULL_HANDLE;
+        set.set  = VK_NULL_HANDLE;
+    }
+
+    auto gpu_culler_t::reserve_clips(ui32 count) -> orb::result<bool>
+    {
+        if (count <= m_clip_capacity)
+        {
+            return false;
+        }
+
+        const ui32 capacity = std::max({ count, m_clip_capacity * 2, min_clip_capacity });
+
+        auto res = gpu_buffer_t::create(*m_pools,
+                                        static_cast<VkDeviceSize>(capacity) * sizeof(clip_entry_t) * m_frames,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (!res)
+        {
+            return res.error();
+        }
+
+        m_clips         = std::move(res.unwrap());
+        m_clip_capacity = capacity;
+
+        return true;
+    }
+
+    void gpu_culler_t::bind_clips(cull_set_t const& set)
+    {
+        const VkDescriptorBufferInfo buffer {
+            .buffer = m_clips.handle(),
+            .offset = 0,
+            .range  = VK_WHOLE_SIZE,
+        };
+
+        const VkWriteDescriptorSet write {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = set.set,
+            .dstBinding      = cull_binding_clips,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo     = &buffer,
+        };
+
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+    }
+
+    auto gpu_culler_t::visible_base(cull_set_t const& set, ui32 frame) const -> ui32
+    {
+        return frame * set.groups * cull_group_size;
+    }
+
+    auto gpu_culler_t::command_base(cull_set_t const& set, ui32 frame) const -> ui32
+    {
+        return frame * set.groups;
+    }
+
+    void gpu_culler_t::record_reset(VkCommandBuffer cmd, cull_set_t const& set, ui32 frame)
+    {
+        vkCmdFillBuffer(cmd, set.counts.handle(), sizeof(ui32) * frame, sizeof(ui32), 0);
+    }
+
+    void gpu_culler_t::record_cull(VkCommandBuffer cmd, cull_set_t const& set, cull_constants_t const& constants)
+    {
+        // Every group runs, even past the item count, so that each one
+        // rewrites its draw of this frame
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cull_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_layout, 0, 1, &set.set, 0, nullptr);
+        vkCmdPushConstants(cmd, m_layout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+        vkCmdDispatch(cmd, set.groups, 1, 1);
+    }
+
+    void gpu_culler_t::record_draw(VkCommandBuffer cmd, cull_set_t const& set, cull_constants_t const& constants, ui32 frame)
+    {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_draw_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_layout, 0, 1, &set.set, 0, nullptr);
+        vkCmdPushConstants(cmd, m_layout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+
+        const VkDeviceSize offset = static_cast<VkDeviceSize>(this->command_base(set, frame)) * sizeof(VkDrawIndexedIndirectCommand);
+
+        if (m_draw_indirect_count)
+        {
+            // The draw count is one past the last group with survivors
+            vkCmdDrawIndexedIndirectCount(cmd,
+                                          set.commands.handle(),
+                                          offset,
+                                          set.counts.handle(),
+                                          sizeof(ui32) * frame,
+                                          set.groups,
+                                          sizeof(VkDrawIndexedIndirectCommand));
+        }
+        else
+        {
+            // Groups without survivors issue empty draws
+            vkCmdDrawIndexedIndirect(cmd, set.commands.handle(), offset, set.groups, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+} // namespace orb::gui
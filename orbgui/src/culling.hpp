@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include "memory.hpp"
+#include "orb/vk/all.hpp"
+
+namespace orb::gui
+{
+    // Items handled by one culling workgroup. Each workgroup owns a fixed
+    // range of the visible list and one indirect draw, which keeps the item
+    // order without a global scan
+    static constexpr ui32 cull_group_size = 256;
+
+    // Shared by the culling and drawing stages, see cull.comp.glsl
+    struct cull_constants_t
+    {
+        std::array<f32, 2> scale;
+        std::array<f32, 2> offset;
+        std::array<f32, 2> extent;
+        ui32               item_count;
+        ui32               clip_count;
+        ui32               visible_base;
+        ui32               command_base;
+        ui32               clip_base;
+        ui32               frame;
+    };
+
+    // Device side of an instance set. Visible lists, draws and draw counts
+    // have one slice per frame in flight
+    struct cull_set_t
+    {
+        gpu_buffer_t     items;
+        gpu_buffer_t     visible;
+        gpu_buffer_t     commands;
+        gpu_buffer_t     counts;
+        VkDescriptorPool pool   = VK_NULL_HANDLE;
+        VkDescriptorSet  set    = VK_NULL_HANDLE;
+        ui32             groups = 0;
+    };
+
+    // Compute culling of instance sets and the pipeline drawing their
+    // survivors through indirect draws
+    class gpu_culler_t
+    {
+    public:
+        gpu_culler_t() = default;
+        ~gpu_culler_t();
+
+        gpu_culler_t(gpu_culler_t const&)                    = delete;
+        gpu_culler_t(gpu_culler_t&&)                         = delete;
+        auto operator=(gpu_culler_t const&) -> gpu_culler_t& = delete;
+        auto operator=(gpu_culler_t&&) -> gpu_culler_t&      = delete;
+
+        // `shader_dir` holds cull.comp.glsl and instance.vs.glsl
+        static auto create(weak<vk::device_t>           device,
+                           memory_pools_t&              pools,
+                           VkRenderPass                 render_pass,
+                           VkShaderModule               fragment_shader,
+                           std::filesystem::path const& shader_dir,
+                           ui32                         frames,
+                           bool                         draw_indirect_count) -> orb::result<box<gpu_culler_t>>;
+
+        auto create_set(ui32 capacity) -> orb::result<cull_set_t>;
+        void destroy_set(cull_set_t& set);
+
+        // Grows the clip buffer, every set must then be rebound
+        auto reserve_clips(ui32 count) -> orb::result<bool>;
+        void bind_clips(cull_set_t const& set);
+
+        [[nodiscard]] auto clip_buffer() const -> VkBuffer { return m_clips.handle(); }
+        [[nodiscard]] auto clip_capacity() const -> ui32 { return m_clip_capacity; }
+
+        // First visible entry and first draw of `frame`'s slices
+        [[nodiscard]] auto visible_base(cull_set_t const& set, ui32 frame) const -> ui32;
+        [[nodiscard]] auto command_base(cull_set_t const& set, ui32 frame) const -> ui32;
+
+        void record_reset(VkCommandBuffer cmd, cull_set_t const& set, ui32 frame);
+        void record_cull(VkCommandBuffer cmd, cull_set_t const& set, cull_constants_t const& constants);
+        void record_draw(VkCommandBuffer cmd, cull_set_t const& set, cull_constants_t const& constants, ui32 frame);
+
+    private:
+        VkDevice              m_device              = VK_NULL_HANDLE;
+        memory_pools_t*       m_pools               = nullptr;
+        vk::shader_module_t   m_cull_shader;
+        vk::shader_module_t   m_vertex_shader;
+        VkDescriptorSetLayout m_set_layout          = VK_NULL_HANDLE;
+        VkPipelineLayout      m_layout              = VK_NULL_HANDLE;
+        VkPipeline            m_cull_pipeline       = VK_NULL_HANDLE;
+        VkPipeline            m_draw_pipeline       = VK_NULL_HANDLE;
+        gpu_buffer_t          m_clips;
+        ui32                  m_clip_capacity       = 0;
+        ui32                  m_frames              = 0;
+        bool                  m_draw_indirect_count = false;
+
+        auto create_pipelines(VkRenderPass render_pass, VkShaderModule fragment_shader) -> orb::result<void>;
+    };
+} // namespace orb::gui
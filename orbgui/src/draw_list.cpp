@@ -0,0 +1,103 @@
+#include "orbgui/draw_list.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace orb::gui
+{
+    void draw_segment_t::clear()
+    {
+        this->vertices.clear();
+        this->indices.clear();
+        this->commands.clear();
+        this->clips.reset();
+    }
+
+    draw_list_t::draw_list_t(ui32 layer)
+        : m_layer(layer)
+    {
+    }
+
+    void draw_list_t::push_clip(clip_rect_t const& rect)
+    {
+        m_segments[m_write].clips.push(rect);
+    }
+
+    void draw_list_t::pop_clip()
+    {
+        m_segments[m_write].clips.pop();
+    }
+
+    void draw_list_t::add_mesh(std::span<const vertex_t> vertices, std::span<const ui16> indices)
+    {
+        auto&      segment = m_segments[m_write];
+        const ui32 clip    = segment.clips.current();
+        const auto base    = static_cast<ui32>(segment.vertices.size());
+
+        // Consecutive meshes sharing layer and clip extend the same command,
+        // as long as its vertices stay addressable by 16 bits indices
+        const bool extend = !segment.commands.empty()
+                         && segment.commands.back().layer == m_layer
+                         && segment.commands.back().clip == clip
+                         && base - static_cast<ui32>(segment.commands.back().vertex_offset) + vertices.size()
+                                <= std::numeric_limits<ui16>::max() + 1u;
+
+        if (!extend)
+        {
+            segment.commands.push_back({
+                .layer         = m_layer,
+                .clip          = clip,
+                .first_index   = static_cast<ui32>(segment.indices.size()),
+                .index_count   = 0,
+                .vertex_offset = static_cast<i32>(base),
+            });
+        }
+
+        auto&      command = segment.commands.back();
+        const auto rebase  = static_cast<ui16>(base - static_cast<ui32>(command.vertex_offset));
+
+        for (const ui16 index : indices)
+        {
+            segment.indices.push_back(static_cast<ui16>(index + rebase));
+        }
+
+        segment.vertices.insert(segment.vertices.end(), vertices.begin(), vertices.end());
+        command.index_count += static_cast<ui32>(indices.size());
+    }
+
+    void draw_list_t::add_rect(f32 x0, f32 y0, f32 x1, f32 y1, std::array<f32, 3> const& color)
+    {
+        const std::array<vertex_t, 4> vertices = { {
+            { { x0, y0 }, color, m_node },
+            { { x1, y0 }, color, m_node },
+            { { x1, y1 }, color, m_node },
+            { { x0, y1 }, color, m_node },
+        } };
+
+        static constexpr std::array<ui16, 6> indices = { 0, 1, 2, 2, 3, 0 };
+
+        this->add_mesh(vertices, indices);
+    }
+
+    void draw_list_t::publish()
+    {
+        auto& segment = m_segments[m_write];
+
+        // Sorting here keeps the render thread down to a merge
+        std::ranges::stable_sort(segment.commands, {}, &draw_cmd_t::layer);
+        segment.version = ++m_published;
+
+        m_write = m_ready.exchange(m_write | fresh, std::memory_order_acq_rel) & ~fresh;
+        m_segments[m_write].clear();
+    }
+
+    auto draw_list_t::acquire() -> draw_segment_t const&
+    {
+        if ((m_ready.load(std::memory_order_relaxed) & fresh) != 0)
+        {
+            m_read = m_ready.exchange(m_read, std::memory_order_acq_rel) & ~fresh;
+        }
+
+        return m_segments[m_read];
+    }
+} // namespace orb::gui
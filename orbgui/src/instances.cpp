@@ -0,0 +1,54 @@
+#include "orbgui/instances.hpp"
+
+#include <algorithm>
+
+namespace orb::gui
+{
+    instance_set_t::instance_set_t(instance_set_create_info_t const& info)
+        : m_viewport(info.viewport)
+        , m_capacity(info.capacity)
+    {
+    }
+
+    auto instance_set_t::write(ui32 first, std::span<const instance_item_t> items) -> orb::result<void>
+    {
+        if (static_cast<ui64>(first) + items.size() > m_capacity)
+        {
+            return orb::error_t { "Instance write [{}, {}) past capacity {}", first, first + items.size(), m_capacity };
+        }
+
+        if (items.empty())
+        {
+            return {};
+        }
+
+        m_uploads.push_back({
+            .first_item    = first,
+            .item_count    = static_cast<ui32>(items.size()),
+            .first_pending = static_cast<ui32>(m_pending.size()),
+        });
+
+        m_pending.insert(m_pending.end(), items.begin(), items.end());
+        m_count = std::max(m_count, first + static_cast<ui32>(items.size()));
+
+        return {};
+    }
+
+    auto instance_set_t::resize(ui32 count) -> orb::result<void>
+    {
+        if (count > m_capacity)
+        {
+            return orb::error_t { "Instance count {} past capacity {}", count, m_capacity };
+        }
+
+        m_count = count;
+
+        return {};
+    }
+
+    void instance_set_t::clear_uploads()
+    {
+        m_uploads.clear();
+        m_pending.clear();
+    }
+} // namespace orb::gui
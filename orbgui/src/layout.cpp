@@ -0,0 +1,561 @@
+#include "orbgui/layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+namespace orb::gui
+{
+    static auto clamp_size(f32 value, f32 lo, f32 hi) -> f32
+    {
+        return std::max(lo, std::min(value, hi));
+    }
+
+    // Narrows the parent's constraints with the node's own size rules
+    static auto constrain(layout_style_t const& style, layout_constraints_t const& c) -> layout_constraints_t
+    {
+        auto axis = [](f32 fixed, f32 lo, f32 hi, f32 c_lo, f32 c_hi) -> std::array<f32, 2> {
+            f32 min = clamp_size(lo, c_lo, c_hi);
+            f32 max = std::max(clamp_size(hi, c_lo, c_hi), min);
+
+            if (fixed >= 0.0f)
+            {
+                min = max = clamp_size(fixed, min, max);
+            }
+
+            return { min, max };
+        };
+
+        const auto [min_width, max_width]   = axis(style.width, style.min_width, style.max_width, c.min_width, c.max_width);
+        const auto [min_height, max_height] = axis(style.height, style.min_height, style.max_height, c.min_height, c.max_height);
+
+        return { min_width, max_width, min_height, max_height };
+    }
+
+    // Main and cross axis views of sizes and constraints
+    struct flex_axes_t
+    {
+        bool row;
+
+        [[nodiscard]] auto main(layout_size_t const& size) const -> f32 { return row ? size.width : size.height; }
+        [[nodiscard]] auto cross(layout_size_t const& size) const -> f32 { return row ? size.height : size.width; }
+        [[nodiscard]] auto min_main(layout_constraints_t const& c) const -> f32 { return row ? c.min_width : c.min_height; }
+        [[nodiscard]] auto max_main(layout_constraints_t const& c) const -> f32 { return row ? c.max_width : c.max_height; }
+        [[nodiscard]] auto min_cross(layout_constraints_t const& c) const -> f32 { return row ? c.min_height : c.min_width; }
+        [[nodiscard]] auto max_cross(layout_constraints_t const& c) const -> f32 { return row ? c.max_height : c.max_width; }
+
+        [[nodiscard]] auto size(f32 main, f32 cross) const -> layout_size_t
+        {
+            return row ? layout_size_t { main, cross } : layout_size_t { cross, main };
+        }
+
+        [[nodiscard]] auto constraints(f32 min_main, f32 max_main, f32 min_cross, f32 max_cross) const -> layout_constraints_t
+        {
+            return row ? layout_constraints_t { min_main, max_main, min_cross, max_cross }
+                       : layout_constraints_t { min_cross, max_cross, min_main, max_main };
+        }
+    };
+
+    layout_tree_t::layout_tree_t()
+    {
+        m_nodes.emplace_back();
+    }
+
+    auto layout_tree_t::add(layout_node_t parent, layout_style_t const& style) -> orb::result<layout_node_t>
+    {
+        if (parent >= m_nodes.size() || !m_nodes[parent].alive)
+        {
+            return orb::error_t { "Invalid layout parent {}", parent };
+        }
+
+        layout_node_t node;
+
+        if (m_free.empty())
+        {
+            node = static_cast<layout_node_t>(m_nodes.size());
+            m_nodes.emplace_back();
+        }
+        else
+        {
+            node = m_free.back();
+            m_free.pop_back();
+            m_nodes[node] = {};
+        }
+
+        auto& n = m_nodes[node];
+        auto& p = m_nodes[parent];
+
+        n.style        = style;
+        n.parent       = parent;
+        n.prev_sibling = p.last_child;
+
+        if (p.last_child != no_layout_node)
+        {
+            m_nodes[p.last_child].next_sibling = node;
+        }
+        else
+        {
+            p.first_child = node;
+        }
+
+        p.last_child = node;
+
+        this->mark_dirty(parent);
+
+        return node;
+    }
+
+    void layout_tree_t::remove(layout_node_t node)
+    {
+        if (node == this->root() || node >= m_nodes.size() || !m_nodes[node].alive)
+        {
+            return;
+        }
+
+        auto& n = m_nodes[node];
+        auto& p = m_nodes[n.parent];
+
+        (n.prev_sibling != no_layout_node ? m_nodes[n.prev_sibling].next_sibling : p.first_child) = n.next_sibling;
+        (n.next_sibling != no_layout_node ? m_nodes[n.next_sibling].prev_sibling : p.last_child)  = n.prev_sibling;
+
+        this->mark_dirty(n.parent);
+
+        // Frees the subtree depth first, reusing the free list as the stack
+        const size_t first = m_free.size();
+        m_free.push_back(node);
+
+        for (size_t i = first; i < m_free.size(); ++i)
+        {
+            auto& freed = m_nodes[m_free[i]];
+
+            for (auto child = freed.first_child; child != no_layout_node; child = m_nodes[child].next_sibling)
+            {
+                m_free.push_back(child);
+            }
+
+            freed.alive   = false;
+            freed.measure = {};
+        }
+    }
+
+    void layout_tree_t::set_style(layout_node_t node, layout_style_t const& style)
+    {
+        m_nodes[node].style = style;
+        this->mark_dirty(node);
+    }
+
+    void layout_tree_t::set_measure(layout_node_t node, layout_measure_t measure)
+    {
+        m_nodes[node].measure = std::move(measure);
+        this->mark_dirty(node);
+    }
+
+    void layout_tree_t::mark_dirty(layout_node_t node)
+    {
+        // Dirty nodes only have dirty ancestors, the walk stops at the first one
+        for (; node != no_layout_node; node = m_nodes[node].parent)
+        {
+            auto& n = m_nodes[node];
+
+            // The ring restarts at the front, lookups only scan the first entries
+            n.measure_count = 0;
+            n.measure_next  = 0;
+
+            if (n.dirty)
+            {
+                break;
+            }
+
+            n.dirty = true;
+        }
+    }
+
+    void layout_tree_t::set_size(f32 width, f32 height)
+    {
+        m_root_constraints = layout_constraints_t::tight(width, height);
+    }
+
+    auto layout_tree_t::update() -> layout_stats_t
+    {
+        m_stats = {};
+        this->layout(this->root(), m_root_constraints);
+
+        return m_stats;
+    }
+
+    auto layout_tree_t::rect(layout_node_t node) const -> layout_rect_t
+    {
+        layout_rect_t rect {
+            .width  = m_nodes[node].size.width,
+            .height = m_nodes[node].size.height,
+        };
+
+        for (; node != no_layout_node; node = m_nodes[node].parent)
+        {
+            rect.x += m_nodes[node].offset[0];
+            rect.y += m_nodes[node].offset[1];
+        }
+
+        return rect;
+    }
+
+    auto layout_tree_t::measure(layout_node_t node, layout_constraints_t const& constraints) -> layout_size_t
+    {
+        auto& n = m_nodes[node];
+
+        if (!n.dirty && n.constraints == constraints)
+        {
+            ++m_stats.cache_hits;
+            return n.size;
+        }
+
+        for (ui32 i = 0; i < n.measure_count; ++i)
+        {
+            if (n.measurements[i].constraints == constraints)
+            {
+                ++m_stats.cache_hits;
+                return n.measurements[i].size;
+            }
+        }
+
+        ++m_stats.measured;
+
+        const auto size = this->compute(node, constraints, false);
+
+        // `n` may have moved, compute never adds nodes but stay on indices
+        auto& cached = m_nodes[node];
+
+        cached.measurements[cached.measure_next] = { constraints, size };
+        cached.measure_next                      = (cached.measure_next + 1) % measure_cache_size;
+        cached.measure_count                     = std::min(cached.measure_count + 1, measure_cache_size);
+
+        return size;
+    }
+
+    auto layout_tree_t::layout(layout_node_t node, layout_constraints_t const& constraints) -> layout_size_t
+    {
+        {
+            auto const& n = m_nodes[node];
+
+            // The whole subtree is still placed for these constraints
+            if (!n.dirty && n.constraints == constraints)
+            {
+                ++m_stats.cache_hits;
+                return n.size;
+            }
+        }
+
+        ++m_stats.laid_out;
+
+        const auto size = this->compute(node, constraints, true);
+
+        auto& n       = m_nodes[node];
+        n.constraints = constraints;
+        n.size        = size;
+        n.dirty       = false;
+
+        return size;
+    }
+
+    auto layout_tree_t::compute(layout_node_t node, layout_constraints_t const& constraints, bool place) -> layout_size_t
+    {
+        auto const& n = m_nodes[node];
+        const auto  c = constrain(n.style, constraints);
+
+        if (n.first_child == no_layout_node)
+        {
+            layout_size_t size { c.min_width, c.min_height };
+
+            if (n.measure)
+            {
+                ++m_stats.leaf_called;
+                size = n.measure(c);
+            }
+
+            return { clamp_size(size.width, c.min_width, c.max_width), clamp_size(size.height, c.min_height, c.max_height) };
+        }
+
+        return n.style.kind == layout_kind::grid ? this->compute_grid(node, c, place) : this->compute_flex(node, c, place);
+    }
+
+    auto layout_tree_t::compute_flex(layout_node_t node, layout_constraints_t const& c, bool place) -> layout_size_t
+    {
+        const auto        style = m_nodes[node].style;
+        const flex_axes_t axes { .row = style.kind == layout_kind::row };
+
+        const f32 pad_main_start  = axes.row ? style.padding[0] : style.padding[1];
+        const f32 pad_cross_start = axes.row ? style.padding[1] : style.padding[0];
+        const f32 pad_main        = axes.row ? style.padding[0] + style.padding[2] : style.padding[1] + style.padding[3];
+        const f32 pad_cross       = axes.row ? style.padding[1] + style.padding[3] : style.padding[0] + style.padding[2];
+
+        const f32  max_main    = std::max(axes.max_main(c) - pad_main, 0.0f);
+        const f32  min_main    = std::max(axes.min_main(c) - pad_main, 0.0f);
+        const f32  max_cross   = std::max(axes.max_cross(c) - pad_cross, 0.0f);
+        const f32  min_cross   = std::max(axes.min_cross(c) - pad_cross, 0.0f);
+        const bool tight_cross = min_cross == max_cross;
+        const bool stretch     = style.align == layout_align::stretch;
+
+        const size_t base  = m_items.size();
+        f32          grow  = 0.0f;
+        f32          total = 0.0f;
+
+        // Flex basis of every child, from its style or its content
+        for (auto child = m_nodes[node].first_child; child != no_layout_node; child = m_nodes[child].next_sibling)
+        {
+            auto const& cs = m_nodes[child].style;
+
+            const f32 fixed    = axes.row ? cs.width : cs.height;
+            const f32 item_min = fixed >= 0.0f ? fixed : (axes.row ? cs.min_width : cs.min_height);
+            const f32 item_max = fixed >= 0.0f ? fixed : (axes.row ? cs.max_width : cs.max_height);
+
+            f32 main = cs.basis;
+
+            if (main < 0.0f)
+            {
+                const auto cross_min = stretch && tight_cross ? max_cross : 0.0f;
+                main = axes.main(this->measure(child, axes.constraints(0.0f, layout_unbounded, cross_min, max_cross)));
+            }
+
+            main = clamp_size(main, item_min, item_max);
+
+            m_items.push_back({
+                .node     = child,
+                .basis    = main,
+                .main     = main,
+                .cross    = 0.0f,
+                .min_main = item_min,
+                .max_main = item_max,
+                .frozen   = false,
+            });
+
+            grow += cs.grow;
+            total += main;
+        }
+
+        const auto items = [&] { return std::span { m_items }.subspan(base); };
+        const f32  gaps  = style.gap * static_cast<f32>(items().size() - 1);
+
+        // A bounded container fills its space when it is tight or has growing children
+        const f32 target = std::isfinite(max_main) && (min_main == max_main || grow > 0.0f)
+                             ? max_main
+                             : clamp_size(total + gaps, min_main, max_main);
+
+        // Resolves the flexible lengths, freezing the children that hit their
+        // min or max and sharing the rest again until none does
+        for (size_t pass = 0; pass <= items().size(); ++pass)
+        {
+            f32 used   = gaps;
+            f32 factor = 0.0f;
+
+            for (size_t i = 0; i < items().size(); ++i)
+            {
+                auto const& item = items()[i];
+                auto const& cs   = m_nodes[item.node].style;
+
+                used += item.frozen ? item.main : item.basis;
+                factor += item.frozen ? 0.0f : (target > total + gaps ? cs.grow : cs.shrink * item.basis);
+            }
+
+            const f32 free = target - used;
+
+            if (free == 0.0f || factor <= 0.0f)
+            {
+                break;
+            }
+
+            bool violated = false;
+
+            for (size_t i = 0; i < items().size(); ++i)
+            {
+                auto& item = items()[i];
+
+                if (item.frozen)
+                {
+                    continue;
+                }
+
+                auto const& cs     = m_nodes[item.node].style;
+                const f32   weight = free > 0.0f ? cs.grow : cs.shrink * item.basis;
+                const f32   main   = item.basis + free * weight / factor;
+
+                item.main = clamp_size(main, item.min_main, item.max_main);
+
+                if (item.main != main)
+                {
+                    item.frozen = true;
+                    violated    = true;
+                }
+            }
+
+            if (!violated)
+            {
+                break;
+            }
+        }
+
+        // Cross sizes: stretched children take the line, others their content
+        f32 line = tight_cross ? max_cross : 0.0f;
+
+        // Measuring pushes onto the item stack, items are re-fetched by index
+        for (size_t i = 0; i < items().size(); ++i)
+        {
+            const auto  item = items()[i];
+            auto const& cs   = m_nodes[item.node].style;
+
+            const bool fixed_cross  = (axes.row ? cs.height : cs.width) >= 0.0f;
+            const bool stretch_item = stretch && !fixed_cross;
+
+            if (stretch_item && tight_cross)
+            {
+                items()[i].cross = max_cross;
+                continue;
+            }
+
+            const f32 cross = axes.cross(this->measure(item.node, axes.constraints(item.main, item.main, 0.0f, max_cross)));
+
+            items()[i].cross = cross;
+            line             = tight_cross ? line : std::max(line, cross);
+        }
+
+        line = clamp_size(line, min_cross, max_cross);
+
+        f32 used = gaps;
+
+        for (auto& item : items())
+        {
+            const bool fixed_cross = (axes.row ? m_nodes[item.node].style.height : m_nodes[item.node].style.width) >= 0.0f;
+
+            item.cross = stretch && !fixed_cross ? line : std::min(item.cross, line);
+            used += item.main;
+        }
+
+        if (place)
+        {
+            f32 position = pad_main_start;
+
+            for (size_t i = 0; i < items().size(); ++i)
+            {
+                // Copied, laying the child out pushes onto the item stack
+                const auto item = items()[i];
+                const auto size = this->layout(item.node, axes.constraints(item.main, item.main, item.cross, item.cross));
+
+                f32 cross = pad_cross_start;
+
+                if (style.align == layout_align::center)
+                {
+                    cross += (line - axes.cross(size)) * 0.5f;
+                }
+                else if (style.align == layout_align::end)
+                {
+                    cross += line - axes.cross(size);
+                }
+
+                m_nodes[item.node].offset = axes.row ? std::array { position, cross } : std::array { cross, position };
+
+                position += axes.main(size) + style.gap;
+            }
+        }
+
+        m_items.resize(base);
+
+        const auto size = axes.size(std::max(target, used) + pad_main, line + pad_cross);
+
+        return { clamp_size(size.width, c.min_width, c.max_width), clamp_size(size.height, c.min_height, c.max_height) };
+    }
+
+    auto layout_tree_t::compute_grid(layout_node_t node, layout_constraints_t const& c, bool place) -> layout_size_t
+    {
+        const auto style   = m_nodes[node].style;
+        const ui32 columns = std::max(style.grid_columns, 1u);
+        const f32  gaps    = style.gap * static_cast<f32>(columns - 1);
+        const f32  pad_x   = style.padding[0] + style.padding[2];
+        const f32  pad_y   = style.padding[1] + style.padding[3];
+        const f32  max_w   = std::max(c.max_width - pad_x, 0.0f);
+
+        const size_t base = m_items.size();
+
+        for (auto child = m_nodes[node].first_child; child != no_layout_node; child = m_nodes[child].next_sibling)
+        {
+            m_items.push_back({ .node = child, .basis = 0.0f, .main = 0.0f, .cross = 0.0f, .min_main = 0.0f, .max_main = 0.0f, .frozen = false });
+        }
+
+        const auto items = [&] { return std::span { m_items }.subspan(base); };
+
+        // Equal columns sharing the width, or as wide as the widest child when unbounded
+        f32 column = 0.0f;
+
+        if (std::isfinite(max_w))
+        {
+            column = std::max((max_w - gaps) / static_cast<f32>(columns), 0.0f);
+        }
+        else
+        {
+            for (size_t i = 0; i < items().size(); ++i)
+            {
+                column = std::max(column, this->measure(items()[i].node, {}).width);
+            }
+        }
+
+        // Each row is as tall as its tallest child
+        f32 height = 0.0f;
+
+        for (size_t first = 0; first < items().size(); first += columns)
+        {
+            const size_t last = std::min(first + columns, items().size());
+            f32          row  = 0.0f;
+
+            for (size_t i = first; i < last; ++i)
+            {
+                const auto measured = this->measure(items()[i].node, { column, column, 0.0f, layout_unbounded });
+
+                items()[i].cross = measured.height;
+                row              = std::max(row, measured.height);
+            }
+
+            for (size_t i = first; i < last; ++i)
+            {
+                items()[i].main = row;
+            }
+
+            height += row + (first == 0 ? 0.0f : style.gap);
+        }
+
+        if (place)
+        {
+            f32 y = style.padding[1];
+
+            for (size_t i = 0; i < items().size(); ++i)
+            {
+                const auto item = items()[i];
+                const auto col  = static_cast<ui32>(i % columns);
+
+                if (col == 0 && i != 0)
+                {
+                    y += items()[i - 1].main + style.gap;
+                }
+
+                const f32  cell_h = style.align == layout_align::stretch ? item.main : item.cross;
+                const auto size   = this->layout(item.node, layout_constraints_t::tight(column, cell_h));
+
+                f32 offset_y = y;
+
+                if (style.align == layout_align::center)
+                {
+                    offset_y += (item.main - size.height) * 0.5f;
+                }
+                else if (style.align == layout_align::end)
+                {
+                    offset_y += item.main - size.height;
+                }
+
+                m_nodes[item.node].offset = { style.padding[0] + static_cast<f32>(col) * (column + style.gap), offset_y };
+            }
+        }
+
+        m_items.resize(base);
+
+        const f32 width = static_cast<f32>(columns) * column + gaps + pad_x;
+
+        return { clamp_size(width, c.min_width, c.max_width), clamp_size(height + pad_y, c.min_height, c.max_height) };
+    }
+} // namespace orb::gui
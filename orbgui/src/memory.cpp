@@ -0,0 +1,528 @@
+#include "memory.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+namespace orb::gui
+{
+    // Streaming buffers, render targets, atlases. Requests over half a block
+    // get a block of their own
+    static constexpr std::array<VkDeviceSize, memory_category_count> block_sizes = {
+        VkDeviceSize { 16 } << 20,
+        VkDeviceSize { 64 } << 20,
+        VkDeviceSize { 32 } << 20,
+    };
+
+    static auto align_up(VkDeviceSize value, VkDeviceSize alignment) -> VkDeviceSize
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // First fit, the alignment padding stays free
+    static auto sub_allocate(memory_block_t& block, VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize>
+    {
+        for (auto it = block.free.begin(); it != block.free.end(); ++it)
+        {
+            const auto [offset, range] = *it;
+            const VkDeviceSize aligned = align_up(offset, alignment);
+
+            if (aligned + size > offset + range)
+            {
+                continue;
+            }
+
+            block.free.erase(it);
+
+            if (aligned > offset)
+            {
+                block.free.emplace(offset, aligned - offset);
+            }
+
+            if (aligned + size < offset + range)
+            {
+                block.free.emplace(aligned + size, offset + range - aligned - size);
+            }
+
+            block.used += size;
+            block.count += 1;
+
+            return aligned;
+        }
+
+        return std::nullopt;
+    }
+
+    static void release(memory_block_t& block, VkDeviceSize offset, VkDeviceSize size)
+    {
+        auto next = block.free.lower_bound(offset);
+
+        if (next != block.free.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = block.free.erase(next);
+        }
+
+        if (next != block.free.begin())
+        {
+            auto prev = std::prev(next);
+
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += size;
+                size = 0;
+            }
+        }
+
+        if (size != 0)
+        {
+            block.free.emplace(offset, size);
+        }
+    }
+
+    memory_pools_t::memory_pools_t(VkDevice device, VkPhysicalDevice gpu, bool memory_budget)
+        : m_device(device)
+        , m_gpu(gpu)
+        , m_memory_budget(memory_budget)
+    {
+        vkGetPhysicalDeviceMemoryProperties(gpu, &m_properties);
+
+        for (ui32 i = 0; i < memory_category_count; ++i)
+        {
+            m_pools[i].block_size = block_sizes[i];
+        }
+    }
+
+    memory_pools_t::~memory_pools_t()
+    {
+        for (auto& pool : m_pools)
+        {
+            for (auto& block : pool.blocks)
+            {
+                vkFreeMemory(m_device, block->memory, nullptr);
+            }
+        }
+    }
+
+    auto memory_pools_t::acquire(VkDevice device, VkPhysicalDevice gpu, bool memory_budget) -> orb::result<std::shared_ptr<memory_pools_t>>
+    {
+        static std::mutex                                           registry_mutex;
+        static std::map<VkDevice, std::weak_ptr<memory_pools_t>> registry;
+
+        std::scoped_lock lock { registry_mutex };
+
+        // Devices whose instances are all gone, a handle may be reused later
+        std::erase_if(registry, [](auto const& entry) { return entry.second.expired(); });
+
+        auto& entry = registry[device];
+        auto  pools = entry.lock();
+
+        if (!pools)
+        {
+            pools = std::make_shared<memory_pools_t>(device, gpu, memory_budget);
+            entry = pools;
+
+            return pools;
+        }
+
+        if (pools->m_gpu != gpu)
+        {
+            return orb::error_t { "GUI instances on one device were given different GPUs" };
+        }
+
+        // The extension is enabled on the device, whichever instance reported it
+        if (memory_budget)
+        {
+            std::scoped_lock pools_lock { pools->m_mutex };
+            pools->m_memory_budget = true;
+        }
+
+        return pools;
+    }
+
+    auto memory_pools_t::find_type(ui32 type_bits, VkMemoryPropertyFlags flags) const -> orb::result<ui32>
+    {
+        for (ui32 i = 0; i < m_properties.memoryTypeCount; ++i)
+        {
+            if ((type_bits & (1u << i)) != 0 && (m_properties.memoryTypes[i].propertyFlags & flags) == flags)
+            {
+                return i;
+            }
+        }
+
+        return orb::error_t { "No memory type with flags {:#x} in type bits {:#x}", flags, type_bits };
+    }
+
+    auto memory_pools_t::fits_budget(ui32 type, VkDeviceSize size) const -> bool
+    {
+        if (!m_memory_budget)
+        {
+            return true;
+        }
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        };
+
+        VkPhysicalDeviceMemoryProperties2 properties {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budget,
+        };
+
+        vkGetPhysicalDeviceMemoryProperties2(m_gpu, &properties);
+
+        const ui32 heap = m_properties.memoryTypes[type].heapIndex;
+
+        return budget.heapUsage[heap] + size <= budget.heapBudget[heap];
+    }
+
+    auto memory_pools_t::create_block(ui32 type, VkDeviceSize size) -> orb::result<std::unique_ptr<memory_block_t>>
+    {
+        auto block = std::make_unique<memory_block_t>();
+
+        const VkMemoryAllocateInfo alloc_info {
+            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize  = size,
+            .memoryTypeIndex = type,
+        };
+
+        if (auto res = vkAllocateMemory(m_device, &alloc_info, nullptr, &block->memory); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Memory block allocation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        // Host visible blocks stay mapped for their whole life
+        if ((m_properties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+        {
+            void* mapped = nullptr;
+
+            if (auto res = vkMapMemory(m_device, block->memory, 0, VK_WHOLE_SIZE, 0, &mapped); res != VK_SUCCESS)
+            {
+                vkFreeMemory(m_device, block->memory, nullptr);
+                return orb::error_t { "Memory block mapping error: {}", vk::vkres::get_repr(res) };
+            }
+
+            block->mapped = static_cast<std::byte*>(mapped);
+        }
+
+        block->size = size;
+        block->type = type;
+        block->free.emplace(0, size);
+
+        return block;
+    }
+
+    auto memory_pools_t::allocate(memory_category       category,
+                                  VkMemoryRequirements  requirements,
+                                  VkMemoryPropertyFlags flags) -> orb::result<memory_allocation_t>
+    {
+        std::scoped_lock lock { m_mutex };
+
+        auto type = this->find_type(requirements.memoryTypeBits, flags);
+
+        if (!type)
+        {
+            return type.error();
+        }
+
+        auto& pool = m_pools[static_cast<ui32>(category)];
+
+        memory_allocation_t allocation {
+            .pools    = this,
+            .category = category,
+            .size     = requirements.size,
+        };
+
+        for (auto& block : pool.blocks)
+        {
+            if (block->type != type.unwrap())
+            {
+                continue;
+            }
+
+            if (auto offset = sub_allocate(*block, requirements.size, requirements.alignment))
+            {
+                allocation.block  = block.get();
+                allocation.offset = *offset;
+                break;
+            }
+        }
+
+        if (allocation.block == nullptr)
+        {
+            VkDeviceSize size = requirements.size > pool.block_size / 2 ? requirements.size : pool.block_size;
+
+            // Near the budget, only take what this request needs
+            if (!this->fits_budget(type.unwrap(), size))
+            {
+                size = requirements.size;
+
+                if (!this->fits_budget(type.unwrap(), size))
+                {
+                    return orb::error_t { "GUI memory request of {} bytes exceeds the memory budget", size };
+                }
+            }
+
+            auto block = this->create_block(type.unwrap(), size);
+
+            if (!block)
+            {
+                return block.error();
+            }
+
+            pool.blocks.push_back(std::move(block.unwrap()));
+
+            allocation.block  = pool.blocks.back().get();
+            allocation.offset = sub_allocate(*allocation.block, requirements.size, requirements.alignment).value();
+        }
+
+        pool.used += requirements.size;
+        pool.allocations += 1;
+
+        return allocation;
+    }
+
+    void memory_pools_t::free(memory_allocation_t const& allocation)
+    {
+        std::scoped_lock lock { m_mutex };
+
+        auto& pool  = m_pools[static_cast<ui32>(allocation.category)];
+        auto& block = *allocation.block;
+
+        release(block, allocation.offset, allocation.size);
+
+        block.used -= allocation.size;
+        block.count -= 1;
+        pool.used -= allocation.size;
+        pool.allocations -= 1;
+
+        // Empty blocks go back to the driver, but the last one of a pool is
+        // kept so that a resize does not reallocate it right away
+        if (block.count == 0 && pool.blocks.size() > 1)
+        {
+            vkFreeMemory(m_device, block.memory, nullptr);
+            std::erase_if(pool.blocks, [&](auto const& candidate) { return candidate.get() == &block; });
+        }
+    }
+
+    auto memory_pools_t::usage() -> memory_usage_t
+    {
+        std::scoped_lock lock { m_mutex };
+
+        memory_usage_t usage;
+
+        for (ui32 i = 0; i < memory_category_count; ++i)
+        {
+            auto const& pool  = m_pools[i];
+            auto&       stats = usage.categories[i];
+
+            VkDeviceSize free    = 0;
+            VkDeviceSize largest = 0;
+
+            for (auto const& block : pool.blocks)
+            {
+                stats.reserved_bytes += block->size;
+
+                for (auto const& [offset, range] : block->free)
+                {
+                    free += range;
+                    largest = std::max(largest, range);
+                }
+            }
+
+            stats.used_bytes    = pool.used;
+            stats.blocks        = static_cast<ui32>(pool.blocks.size());
+            stats.allocations   = pool.allocations;
+            stats.fragmentation = free == 0 ? 0.0f : 1.0f - static_cast<f32>(largest) / static_cast<f32>(free);
+        }
+
+        if (m_memory_budget)
+        {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budget {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+            };
+
+            VkPhysicalDeviceMemoryProperties2 properties {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+                .pNext = &budget,
+            };
+
+            vkGetPhysicalDeviceMemoryProperties2(m_gpu, &properties);
+
+            for (ui32 heap = 0; heap < m_properties.memoryHeapCount; ++heap)
+            {
+                if ((m_properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0)
+                {
+                    usage.budget_bytes += budget.heapBudget[heap];
+                    usage.usage_bytes += budget.heapUsage[heap];
+                }
+            }
+        }
+
+        return usage;
+    }
+
+    gpu_buffer_t::~gpu_buffer_t()
+    {
+        this->destroy();
+    }
+
+    gpu_buffer_t::gpu_buffer_t(gpu_buffer_t&& other) noexcept
+        : m_buffer(std::exchange(other.m_buffer, VK_NULL_HANDLE))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_allocation(std::exchange(other.m_allocation, {}))
+    {
+    }
+
+    auto gpu_buffer_t::operator=(gpu_buffer_t&& other) noexcept -> gpu_buffer_t&
+    {
+        if (this != &other)
+        {
+            this->destroy();
+
+            m_buffer     = std::exchange(other.m_buffer, VK_NULL_HANDLE);
+            m_size       = std::exchange(other.m_size, 0);
+            m_allocation = std::exchange(other.m_allocation, {});
+        }
+
+        return *this;
+    }
+
+    void gpu_buffer_t::destroy()
+    {
+        if (m_buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(m_allocation.pools->device(), m_buffer, nullptr);
+        }
+
+        if (m_allocation.block != nullptr)
+        {
+            m_allocation.pools->free(m_allocation);
+        }
+
+        m_buffer     = VK_NULL_HANDLE;
+        m_allocation = {};
+    }
+
+    auto gpu_buffer_t::create(memory_pools_t&       pools,
+                              VkDeviceSize          size,
+                              VkBufferUsageFlags    usage,
+                              VkMemoryPropertyFlags memory,
+                              memory_category       category) -> orb::result<gpu_buffer_t>
+    {
+        const VkBufferCreateInfo buffer_info {
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = size,
+            .usage       = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+
+        VkBuffer handle = VK_NULL_HANDLE;
+
+        if (auto res = vkCreateBuffer(pools.device(), &buffer_info, nullptr, &handle); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Buffer creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(pools.device(), handle, &requirements);
+
+        auto allocation = pools.allocate(category, requirements, memory);
+
+        if (!allocation)
+        {
+            vkDestroyBuffer(pools.device(), handle, nullptr);
+            return allocation.error();
+        }
+
+        gpu_buffer_t buffer;
+        buffer.m_buffer     = handle;
+        buffer.m_size       = size;
+        buffer.m_allocation = allocation.unwrap();
+
+        auto const& bound = buffer.m_allocation;
+
+        if (auto res = vkBindBufferMemory(pools.device(), handle, bound.block->memory, bound.offset); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Buffer memory binding error: {}", vk::vkres::get_repr(res) };
+        }
+
+        return buffer;
+    }
+
+    gpu_image_t::~gpu_image_t()
+    {
+        this->destroy();
+    }
+
+    gpu_image_t::gpu_image_t(gpu_image_t&& other) noexcept
+        : m_image(std::exchange(other.m_image, VK_NULL_HANDLE))
+        , m_allocation(std::exchange(other.m_allocation, {}))
+    {
+    }
+
+    auto gpu_image_t::operator=(gpu_image_t&& other) noexcept -> gpu_image_t&
+    {
+        if (this != &other)
+        {
+            this->destroy();
+
+            m_image      = std::exchange(other.m_image, VK_NULL_HANDLE);
+            m_allocation = std::exchange(other.m_allocation, {});
+        }
+
+        return *this;
+    }
+
+    void gpu_image_t::destroy()
+    {
+        if (m_image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_allocation.pools->device(), m_image, nullptr);
+        }
+
+        if (m_allocation.block != nullptr)
+        {
+            m_allocation.pools->free(m_allocation);
+        }
+
+        m_image      = VK_NULL_HANDLE;
+        m_allocation = {};
+    }
+
+    auto gpu_image_t::create(memory_pools_t&          pools,
+                             VkImageCreateInfo const& info,
+                             memory_category          category) -> orb::result<gpu_image_t>
+    {
+        VkImage handle = VK_NULL_HANDLE;
+
+        if (auto res = vkCreateImage(pools.device(), &info, nullptr, &handle); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Image creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(pools.device(), handle, &requirements);
+
+        auto allocation = pools.allocate(category, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (!allocation)
+        {
+            vkDestroyImage(pools.device(), handle, nullptr);
+            return allocation.error();
+        }
+
+        gpu_image_t image;
+        image.m_image      = handle;
+        image.m_allocation = allocation.unwrap();
+
+        auto const& bound = image.m_allocation;
+
+        if (auto res = vkBindImageMemory(pools.device(), handle, bound.block->memory, bound.offset); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Image memory binding error: {}", vk::vkres::get_repr(res) };
+        }
+
+        return image;
+    }
+} // namespace orb::gui
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <orb/result.hpp>
+
+#include "orb/vk/all.hpp"
+#include "orbgui/orbgui.hpp"
+
+namespace orb::gui
+{
+    class memory_pools_t;
+
+    // Device memory block carved into sub-allocations
+    struct memory_block_t
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize   size   = 0;
+        VkDeviceSize   used   = 0;
+        ui32           type   = 0;
+        ui32           count  = 0;
+        std::byte*     mapped = nullptr;
+
+        // Free ranges by offset, neighbours always coalesced
+        std::map<VkDeviceSize, VkDeviceSize> free;
+    };
+
+    struct memory_allocation_t
+    {
+        memory_pools_t* pools    = nullptr;
+        memory_block_t* block    = nullptr;
+        memory_category category = memory_category::streaming;
+        VkDeviceSize    offset   = 0;
+        VkDeviceSize    size     = 0;
+
+        [[nodiscard]] auto mapped() const -> std::byte* { return block->mapped == nullptr ? nullptr : block->mapped + offset; }
+    };
+
+    // Pools of large device memory blocks, one per category, sub-allocated
+    // first fit. The pools are shared by every instance created on the same
+    // device, so many small GUIs stay well under the driver allocation count
+    // limit. New blocks are checked against VK_EXT_memory_budget when enabled
+    class memory_pools_t
+    {
+    public:
+        memory_pools_t(VkDevice device, VkPhysicalDevice gpu, bool memory_budget);
+        ~memory_pools_t();
+
+        memory_pools_t(memory_pools_t const&)                    = delete;
+        memory_pools_t(memory_pools_t&&)                         = delete;
+        auto operator=(memory_pools_t const&) -> memory_pools_t& = delete;
+        auto operator=(memory_pools_t&&) -> memory_pools_t&      = delete;
+
+        // The pools of `device`, created on first use. Every caller must pass
+        // the same GPU, budget checks start once any caller enables them
+        static auto acquire(VkDevice device, VkPhysicalDevice gpu, bool memory_budget) -> orb::result<std::shared_ptr<memory_pools_t>>;
+
+        auto allocate(memory_category       category,
+                      VkMemoryRequirements  requirements,
+                      VkMemoryPropertyFlags flags) -> orb::result<memory_allocation_t>;
+        void free(memory_allocation_t const& allocation);
+
+        [[nodiscard]] auto usage() -> memory_usage_t;
+        [[nodiscard]] auto device() const -> VkDevice { return m_device; }
+
+    private:
+        struct pool_t
+        {
+            VkDeviceSize                                 block_size;
+            std::vector<std::unique_ptr<memory_block_t>> blocks;
+            ui64                                         used        = 0;
+            ui32                                         allocations = 0;
+        };
+
+        VkDevice                         m_device;
+        VkPhysicalDevice                 m_gpu;
+        bool                             m_memory_budget;
+        VkPhysicalDeviceMemoryProperties m_properties;
+        std::mutex                       m_mutex;
+
+        std::array<pool_t, memory_category_count> m_pools;
+
+        [[nodiscard]] auto find_type(ui32 type_bits, VkMemoryPropertyFlags flags) const -> orb::result<ui32>;
+        [[nodiscard]] auto fits_budget(ui32 type, VkDeviceSize size) const -> bool;
+        auto               create_block(ui32 type, VkDeviceSize size) -> orb::result<std::unique_ptr<memory_block_t>>;
+    };
+
+    // Buffer sub-allocated from the pools
+    class gpu_buffer_t
+    {
+    public:
+        gpu_buffer_t() = default;
+        ~gpu_buffer_t();
+
+        gpu_buffer_t(gpu_buffer_t const&)                    = delete;
+        gpu_buffer_t(gpu_buffer_t&& other) noexcept;
+        auto operator=(gpu_buffer_t const&) -> gpu_buffer_t& = delete;
+        auto operator=(gpu_buffer_t&& other) noexcept -> gpu_buffer_t&;
+
+        static auto create(memory_pools_t&       pools,
+                           VkDeviceSize          size,
+                           VkBufferUsageFlags    usage,
+                           VkMemoryPropertyFlags memory,
+                           memory_category       category = memory_category::streaming) -> orb::result<gpu_buffer_t>;
+
+        [[nodiscard]] auto handle() const -> VkBuffer { return m_buffer; }
+        [[nodiscard]] auto size() const -> VkDeviceSize { return m_size; }
+
+        // Null unless the memory is host visible
+        [[nodiscard]] auto mapped() const -> std::byte* { return m_allocation.block == nullptr ? nullptr : m_allocation.mapped(); }
+
+    private:
+        VkBuffer            m_buffer = VK_NULL_HANDLE;
+        VkDeviceSize        m_size   = 0;
+        memory_allocation_t m_allocation;
+
+        void destroy();
+    };
+
+    // Optimal tiling image sub-allocated from the pools
+    class gpu_image_t
+    {
+    public:
+        gpu_image_t() = default;
+        ~gpu_image_t();
+
+        gpu_image_t(gpu_image_t const&)                    = delete;
+        gpu_image_t(gpu_image_t&& other) noexcept;
+        auto operator=(gpu_image_t const&) -> gpu_image_t& = delete;
+        auto operator=(gpu_image_t&& other) noexcept -> gpu_image_t&;
+
+        static auto create(memory_pools_t&          pools,
+                           VkImageCreateInfo const& info,
+                           memory_category          category) -> orb::result<gpu_image_t>;
+
+        [[nodiscard]] auto handle() const -> VkImage { return m_image; }
+
+    private:
+        VkImage             m_image = VK_NULL_HANDLE;
+        memory_allocation_t m_allocation;
+
+        void destroy();
+    };
+} // namespace orb::gui
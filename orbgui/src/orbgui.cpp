@@ -1,42 +1,113 @@
 #include <orb/renderer.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "culling.hpp"
+#include "memory.hpp"
 #include "orb/vk/all.hpp"
+#include "orbgui/animation.hpp"
+#include "orbgui/capture.hpp"
+#include "orbgui/clip.hpp"
+#include "orbgui/draw_list.hpp"
+#include "orbgui/instances.hpp"
+#include "orbgui/layout.hpp"
 #include "orbgui/orbgui.hpp"
+#include "orbgui/plot.hpp"
+#include "pipeline.hpp"
 
 namespace orb::gui
 {
     static constexpr ui32 max_frames_in_flight = 2;
 
-    struct gui_renderer_t
+    // Clipping happens in the fragment shader, the clip being picked by the
+    // instance index, so clip changes never split draws. A scissor only pays
+    // off for a long run of draws sharing a rectangular clip: a single state
+    // change then saves rasterizing every clipped fragment
+    static constexpr ui32 scissor_min_draws = 32;
+
+    // Scissor matching the bounds of `clip`, within `viewport`
+    static auto clip_scissor(clip_entry_t const& clip, VkRect2D const& viewport) -> VkRect2D
     {
-        // device
-        weak<vk::device_t>  device;
-        box<vk::cmd_pool_t> graphics_cmd_pool;
-        box<vk::cmd_pool_t> transfer_cmd_pool;
-        vk::cmd_buffers_t   draw_cmds;
-        VkQueue             graphics_queue;
-        VkQueue             transfer_queue;
+        const auto x0 = std::max(static_cast<i32>(std::floor(clip.bounds[0])), viewport.offset.x);
+        const auto y0 = std::max(static_cast<i32>(std::floor(clip.bounds[1])), viewport.offset.y);
+        const auto x1 = std::min(static_cast<i32>(std::ceil(clip.bounds[2])), viewport.offset.x + static_cast<i32>(viewport.extent.width));
+        const auto y1 = std::min(static_cast<i32>(std::ceil(clip.bounds[3])), viewport.offset.y + static_cast<i32>(viewport.extent.height));
+
+        return {
+            .offset = { x0, y0 },
+            .extent = { static_cast<ui32>(std::max(x1 - x0, 0)), static_cast<ui32>(std::max(y1 - y0, 0)) },
+        };
+    }
 
-        // render pass
-        box<vk::render_pass_t> render_pass;
-        vk::attachments_t      attachments;
-        vk::subpasses_t        subpasses;
-        vk::images_t           images;
-        vk::views_t            views;
-        vk::framebuffers_t     fbs;
-        VkExtent2D             extent;
+    using frame_clock_t = std::chrono::steady_clock;
+    using time_point_t  = frame_clock_t::time_point;
 
-        // graphics pipeline
-        vk::shader_module_t          vs_shader_module;
-        vk::shader_module_t          fs_shader_module;
-        box<vk::graphics_pipeline_t> pipeline;
-        vk::vertex_buffer_t          vertex_buffer;
-        vk::index_buffer_t           index_buffer;
+    static auto to_ms(frame_clock_t::duration duration) -> f64
+    {
+        return std::chrono::duration<f64, std::milli>(duration).count();
+    }
+
+    // Node table of replays that captured none, the root alone
+    static const std::array<node_params_t, 1> untransformed = {};
+
+    // Last N measurements of a frame timing
+    template <size_t N>
+    struct timing_window_t
+    {
+        std::array<f64, N> values = {};
+        size_t             count  = 0;
+        size_t             next   = 0;
+
+        void push(f64 value)
+        {
+            values[next] = value;
+            next         = (next + 1) % N;
+            count        = std::min(count + 1, N);
+        }
+
+        [[nodiscard]] auto max() const -> f64
+        {
+            return count == 0 ? 0.0 : *std::max_element(values.begin(), values.begin() + count);
+        }
+
+        [[nodiscard]] auto min() const -> f64
+        {
+            return count == 0 ? 0.0 : *std::min_element(values.begin(), values.begin() + count);
+        }
+    };
+
+    // Output surface of an instance. Device objects (render pass, pipeline,
+    // buffers, command pools, staging) are shared by all the viewports, only
+    // the render targets, command buffers and semaphores are per viewport
+    struct viewport_t
+    {
+        weak<vk::device_t> device;
+        memory_pools_t*    pools;
+        VkRenderPass       render_pass;
+        VkExtent2D         extent;
+
+        // render targets
+        std::vector<gpu_image_t> images;
+        std::vector<VkImage>     image_handles;
+        vk::views_t              views;
+        vk::framebuffers_t       fbs;
 
         // render info
-        ui32                  frame = 0;
+        vk::cmd_buffers_t     draw_cmds;
         vk::semaphores_t      render_finished;
         vk::semaphores_view_t finished;
+        ui32                  rendered = 0;
+
+        // widget layout, sized to the extent
+        layout_tree_t layout;
 
         auto create_surfaces() -> orb::result<void>
         {
@@ -55,23 +126,46 @@ namespace orb::gui
 
         auto create_images() -> orb::result<void>
         {
-            auto res = vk::images_builder_t::prepare(this->device->allocator)
-                           .unwrap()
-                           .count(max_frames_in_flight)
-                           .usage(vk::image_usage_flag::color_attachment)
-                           .usage(vk::image_usage_flag::transfer_src)
-                           .size(extent.width, extent.height)
-                           .format(vk::format::b8g8r8a8_unorm)
-                           .mem_usage(vk::memory_usage::usage_auto)
-                           .mem_flags(vk::memory_flag::dedicated_memory)
-                           .build();
-
-            if (!res)
+            const VkImageCreateInfo image_info {
+                .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .imageType     = VK_IMAGE_TYPE_2D,
+                .format        = VK_FORMAT_B8G8R8A8_UNORM,
+                .extent        = { .width = extent.width, .height = extent.height, .depth = 1 },
+                .mipLevels     = 1,
+                .arrayLayers   = 1,
+                .samples       = VK_SAMPLE_COUNT_1_BIT,
+                .tiling        = VK_IMAGE_TILING_OPTIMAL,
+                .usage         = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            };
+
+            // In-flight frames may still render to the old targets, or to the
+            // views and framebuffers replaced after them
+            if (!this->images.empty())
             {
-                return res.error();
+                if (auto res = this->device->wait(); !res)
+                {
+                    return res;
+                }
             }
 
-            this->images = std::move(res.unwrap());
+            // Old targets go back to the pool first, so a resize can reuse their range
+            this->images.clear();
+            this->image_handles.clear();
+
+            for (ui32 i = 0; i < max_frames_in_flight; ++i)
+            {
+                auto res = gpu_image_t::create(*this->pools, image_info, memory_category::render_targets);
+
+                if (!res)
+                {
+                    return res.error();
+                }
+
+                this->images.push_back(std::move(res.unwrap()));
+                this->image_handles.push_back(this->images.back().handle());
+            }
 
             return {};
         }
@@ -80,7 +174,7 @@ namespace orb::gui
         {
             auto res = vk::views_builder_t::prepare(this->device->handle)
                            .unwrap()
-                           .images(this->images.handles)
+                           .images(this->image_handles)
                            .aspect_mask(vk::image_aspect_flag::color)
                            .format(vk::format::b8g8r8a8_unorm)
                            .build();
@@ -97,53 +191,1377 @@ namespace orb::gui
 
         auto create_fbs() -> orb::result<void>
         {
-            auto res = vk::framebuffers_builder_t::prepare(device, render_pass->handle)
+            auto res = vk::framebuffers_builder_t::prepare(device, render_pass)
                            .unwrap()
                            .size(extent.width, extent.height)
                            .attachments(views.handles)
                            .build();
 
-            if (!res)
+            if (!res)
+            {
+                return res.error();
+            }
+
+            this->fbs = std::move(res.unwrap());
+
+            return {};
+        };
+    };
+
+    struct gui_renderer_t
+    {
+        gui_renderer_t() = default;
+
+        gui_renderer_t(gui_renderer_t const&)                    = delete;
+        gui_renderer_t(gui_renderer_t&&)                         = delete;
+        auto operator=(gui_renderer_t const&) -> gui_renderer_t& = delete;
+        auto operator=(gui_renderer_t&&) -> gui_renderer_t&      = delete;
+
+        ~gui_renderer_t()
+        {
+            for (auto& slot : this->instance_sets)
+            {
+                this->culler->destroy_set(slot.gpu);
+            }
+
+            if (this->timestamps != VK_NULL_HANDLE)
+            {
+                vkDestroyQueryPool(this->device->handle, this->timestamps, nullptr);
+            }
+        }
+
+        // device
+        weak<vk::device_t>              device;
+        std::shared_ptr<memory_pools_t> pools;
+        box<vk::cmd_pool_t>             graphics_cmd_pool;
+        box<vk::cmd_pool_t> transfer_cmd_pool;
+        vk::cmd_buffers_t   upload_cmds;
+        VkQueue             graphics_queue;
+        VkQueue             transfer_queue;
+
+        // render pass
+        box<vk::render_pass_t> render_pass;
+        vk::attachments_t      attachments;
+        vk::subpasses_t        subpasses;
+
+        // graphics pipeline
+        vk::shader_module_t          vs_shader_module;
+        vk::shader_module_t          fs_shader_module;
+        box<gui_pipeline_t>          pipeline;
+        gpu_buffer_t                 vertex_buffer;
+        gpu_buffer_t                 index_buffer;
+        std::vector<vertex_t>        quad_vertices;
+        std::vector<ui16>            quad_indices;
+
+        // plots
+        struct plot_slot_t
+        {
+            box<plot_t>               plot;
+            ui32                      viewport;
+            gpu_buffer_t              vertices;
+            std::vector<VkBufferCopy> copies;
+        };
+
+        std::vector<plot_slot_t>  plots;
+        gpu_buffer_t              band_indices;
+        std::vector<gpu_buffer_t> staging;
+        std::vector<std::byte>    upload_scratch;
+
+        // clipping, one slice of the clip buffer per frame in flight
+        struct queued_draw_t
+        {
+            VkBuffer    vertices;
+            VkBuffer    indices;
+            VkIndexType index_type;
+            ui32        first_index;
+            ui32        index_count;
+            i32         vertex_offset;
+            ui32        clip;
+        };
+
+        clip_stack_t                  clips;
+        clip_stack_t                  unclipped;
+        std::span<const clip_entry_t> frame_clips;
+        gpu_buffer_t                  clip_buffer;
+        ui32                          clip_capacity = 0;
+        std::vector<VkBufferCopy>     clip_copies;
+        std::vector<queued_draw_t>    queued_draws;
+        std::vector<clip_entry_t>     merged_clips;
+
+        // node parameters, one slice of the node buffer per frame in flight
+        animator_t                     animator;
+        time_point_t                   epoch;
+        std::span<const node_params_t> frame_nodes;
+        gpu_buffer_t                   node_buffer;
+        ui32                           node_capacity = 0;
+        std::vector<VkBufferCopy>      node_copies;
+
+        // draw lists, one slice of their buffers per frame in flight
+        struct draw_list_slot_t
+        {
+            box<draw_list_t>                       list;
+            ui32                                   viewport;
+            draw_segment_t const*                  segment = nullptr;
+            gpu_buffer_t                           vertices;
+            gpu_buffer_t                           indices;
+            ui32                                   vertex_capacity = 0;
+            ui32                                   index_capacity  = 0;
+            std::array<ui64, max_frames_in_flight> uploaded        = {};
+            ui32                                   clip_base       = 0;
+            std::vector<VkBufferCopy>              vertex_copies;
+            std::vector<VkBufferCopy>              index_copies;
+        };
+
+        struct draw_cursor_t
+        {
+            draw_list_slot_t const* slot;
+            size_t                  next;
+        };
+
+        std::vector<draw_list_slot_t> draw_lists;
+        std::vector<draw_cursor_t>    draw_cursors;
+
+        // instance sets, culled and drawn from the GPU
+        struct instance_slot_t
+        {
+            box<instance_set_t>       set;
+            cull_set_t                gpu;
+            std::vector<VkBufferCopy> copies;
+            cull_constants_t          constants = {};
+        };
+
+        VkPhysicalDevice             gpu                 = VK_NULL_HANDLE;
+        std::filesystem::path        shader_dir;
+        bool                         multi_draw_indirect = false;
+        bool                         draw_indirect_count = false;
+        box<gpu_culler_t>            culler;
+        std::vector<instance_slot_t> instance_sets;
+        std::vector<VkBufferCopy>    culler_clip_copies;
+
+        // capture and replay
+        struct replay_buffer_t
+        {
+            capture_buffer_usage      usage;
+            ui64                      size = 0;
+            gpu_buffer_t              buffer;
+            std::vector<VkBufferCopy> copies;
+            std::vector<ui16>         indices; // CPU copy of index buffers, bounds the replayed draws
+        };
+
+        std::optional<capture_writer_t>           capture;
+        bool                                      capture_resources_pending = false;
+        replay_frame_t const*                     replay                    = nullptr;
+        std::unordered_map<ui32, replay_buffer_t> replay_buffers;
+
+        // viewports
+        std::vector<box<viewport_t>> viewports;
+        std::vector<VkCommandBuffer> submit_cmds;
+        std::vector<VkSemaphore>     submit_signals;
+        ui32                         frame = 0;
+
+        // frame pacing
+        struct frame_timing_t
+        {
+            ui64         frame_number = 0;
+            time_point_t latch;
+            time_point_t submit;
+            bool         pending = false;
+        };
+
+        VkQueryPool                                      timestamps       = VK_NULL_HANDLE;
+        f64                                              timestamp_period = 0.0;
+        vk::cmd_buffers_t                                timestamp_cmds;
+        frame_pacing_t                                   pacing;
+        std::array<frame_timing_t, max_frames_in_flight> timings;
+        timing_window_t<16>                              cpu_ms;
+        timing_window_t<16>                              gpu_ms;
+        timing_window_t<128>                             clock_offsets_ns;
+        frame_latency_t                                  last_latency;
+        time_point_t                                     latch;
+        time_point_t                                     next_deadline; // low latency pacing, absolute
+        bool                                             latched      = false;
+        ui64                                             frame_number = 0;
+
+        // Resolves the timings of the previous use of this frame slot. The
+        // caller waited for its frame fence, so the queries are available
+        void collect_timings()
+        {
+            auto& timing = this->timings[this->frame];
+
+            if (!timing.pending)
+            {
+                return;
+            }
+
+            timing.pending = false;
+
+            frame_latency_t latency {
+                .frame              = timing.frame_number,
+                .input_to_submit_ms = to_ms(timing.submit - timing.latch),
+            };
+
+            this->cpu_ms.push(latency.input_to_submit_ms);
+
+            std::array<ui64, 2> ticks = {};
+
+            if (this->timestamps != VK_NULL_HANDLE
+                && vkGetQueryPoolResults(this->device->handle,
+                                         this->timestamps,
+                                         this->frame * 2,
+                                         2,
+                                         sizeof(ticks),
+                                         ticks.data(),
+                                         sizeof(ui64),
+                                         VK_QUERY_RESULT_64_BIT)
+                       == VK_SUCCESS)
+            {
+                // GPU and CPU clocks are unrelated: their offset is estimated as
+                // the smallest submit-to-start gap seen recently, when the GPU was idle
+                const auto submit_ns    = static_cast<f64>(std::chrono::nanoseconds(timing.submit.time_since_epoch()).count());
+                const auto gpu_start_ns = static_cast<f64>(ticks[0]) * this->timestamp_period;
+                const auto gpu_end_ns   = static_cast<f64>(ticks[1]) * this->timestamp_period;
+
+                this->clock_offsets_ns.push(gpu_start_ns - submit_ns);
+
+                latency.gpu_ms                = (gpu_end_ns - gpu_start_ns) * 1e-6;
+                latency.submit_to_complete_ms = (gpu_end_ns - this->clock_offsets_ns.min() - submit_ns) * 1e-6;
+
+                this->gpu_ms.push(latency.gpu_ms);
+            }
+
+            this->last_latency = latency;
+        }
+
+        auto create_viewport(ui32 width, ui32 height) -> orb::result<ui32>
+        {
+            auto vp = make_box<viewport_t>();
+
+            vp->device      = this->device;
+            vp->pools       = this->pools.get();
+            vp->render_pass = this->render_pass->handle;
+            vp->extent      = { .width = width, .height = height };
+
+            vp->layout.set_size(static_cast<f32>(width), static_cast<f32>(height));
+
+            if (auto res = vp->create_surfaces(); !res)
+            {
+                return res.error();
+            }
+
+            auto cmds_res = this->graphics_cmd_pool->alloc_cmds(max_frames_in_flight);
+
+            if (!cmds_res)
+            {
+                return cmds_res.error();
+            }
+
+            vp->draw_cmds = std::move(cmds_res.unwrap());
+
+            auto sems_res = vk::semaphores_builder_t::prepare(this->device)
+                                .unwrap()
+                                .count(max_frames_in_flight)
+                                .stage(vk::pipeline_stage_flag::transfer)
+                                .build();
+
+            if (!sems_res)
+            {
+                return sems_res.error();
+            }
+
+            vp->render_finished = std::move(sems_res.unwrap());
+
+            this->viewports.push_back(std::move(vp));
+
+            return static_cast<ui32>(this->viewports.size() - 1);
+        }
+
+        // Device local buffer, written through transfers only
+        auto create_buffer(VkDeviceSize size, VkBufferUsageFlags usage) -> orb::result<gpu_buffer_t>
+        {
+            return gpu_buffer_t::create(*this->pools,
+                                        size,
+                                        usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+
+        auto create_staging(VkDeviceSize size) -> orb::result<gpu_buffer_t>
+        {
+            return gpu_buffer_t::create(*this->pools,
+                                        size,
+                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+
+        // Blocking upload through a temporary staging buffer, for setup only
+        auto upload_now(VkBuffer dst, void const* data, VkDeviceSize size) -> orb::result<void>
+        {
+            auto staging_res = this->create_staging(size);
+
+            if (!staging_res)
+            {
+                return staging_res.error();
+            }
+
+            auto staging_buffer = std::move(staging_res.unwrap());
+            std::memcpy(staging_buffer.mapped(), data, size);
+
+            auto cpy_cmd = this->transfer_cmd_pool->alloc_cmds(1).unwrap().get(0).unwrap();
+
+            cpy_cmd.begin_one_time().unwrap();
+            cpy_cmd.copy_buffer(staging_buffer.handle(), dst, size);
+            cpy_cmd.end().unwrap();
+
+            vk::submit_helper_t::prepare()
+                .cmd_buffer(&cpy_cmd.handle)
+                .submit(this->transfer_queue)
+                .unwrap();
+
+            return this->device->wait();
+        }
+
+        // Records every device buffer the frame stream references, with its
+        // current content, so a capture can be replayed from its first frame
+        void capture_resources()
+        {
+            auto upload_all = [&](ui32 id, capture_buffer_usage usage, std::span<const std::byte> bytes) {
+                this->capture->create_buffer(id, usage, bytes.size());
+                this->capture->upload(id, 0, bytes);
+            };
+
+            upload_all(capture_quad_vertices, capture_buffer_usage::vertex, std::as_bytes(std::span { this->quad_vertices }));
+            upload_all(capture_quad_indices, capture_buffer_usage::index, std::as_bytes(std::span { this->quad_indices }));
+
+            if (!this->plots.empty())
+            {
+                std::vector<ui16> indices;
+                plot_t::band_indices(indices);
+                upload_all(capture_band_indices, capture_buffer_usage::index, std::as_bytes(std::span { indices }));
+            }
+
+            for (ui32 i = 0; i < this->plots.size(); ++i)
+            {
+                upload_all(capture_first_plot + i, capture_buffer_usage::vertex, std::as_bytes(this->plots[i].plot->vertices()));
+            }
+
+            this->capture_resources_pending = false;
+        }
+
+        // Gathers the plot columns that changed since last frame
+        void gather_plot_uploads()
+        {
+            for (ui32 i = 0; i < this->plots.size(); ++i)
+            {
+                auto& slot = this->plots[i];
+
+                slot.copies.clear();
+                auto const& extent = this->viewports[slot.viewport]->extent;
+                slot.plot->update(static_cast<f32>(extent.width), static_cast<f32>(extent.height));
+
+                auto vertices = slot.plot->vertices();
+
+                for (auto const& upload : slot.plot->uploads())
+                {
+                    auto changed = std::as_bytes(vertices.subspan(upload.first_vertex, upload.vertex_count));
+
+                    slot.copies.push_back({
+                        .srcOffset = this->upload_scratch.size(),
+                        .dstOffset = upload.first_vertex * sizeof(vertex_t),
+                        .size      = changed.size(),
+                    });
+
+                    this->upload_scratch.insert(this->upload_scratch.end(), changed.begin(), changed.end());
+
+                    if (this->capture)
+                    {
+                        this->capture->upload(capture_first_plot + i, slot.copies.back().dstOffset, changed);
+                    }
+                }
+            }
+        }
+
+        auto gather_replay_uploads() -> orb::result<void>
+        {
+            for (auto& [id, buffer] : this->replay_buffers)
+            {
+                buffer.copies.clear();
+            }
+
+            for (auto const& upload : this->replay->uploads)
+            {
+                auto it = this->replay_buffers.find(upload.buffer);
+
+                // Checked without adding, a crafted offset could wrap the sum
+                if (it == this->replay_buffers.end()
+                    || upload.offset > it->second.size
+                    || upload.data.size() > it->second.size - upload.offset)
+                {
+                    return orb::error_t { "Replay upload to unknown or too small buffer {}", upload.buffer };
+                }
+
+                it->second.copies.push_back({
+                    .srcOffset = this->upload_scratch.size(),
+                    .dstOffset = upload.offset,
+                    .size      = upload.data.size(),
+                });
+
+                if (it->second.usage == capture_buffer_usage::index && !upload.data.empty())
+                {
+                    std::memcpy(reinterpret_cast<std::byte*>(it->second.indices.data()) + upload.offset, upload.data.data(), upload.data.size());
+                }
+
+                this->upload_scratch.insert(this->upload_scratch.end(), upload.data.begin(), upload.data.end());
+            }
+
+            return {};
+        }
+
+        // Picks the latest segment of every draw list and gathers the ones this
+        // frame's slice does not hold yet. Producers are never waited on
+        auto gather_draw_list_uploads() -> orb::result<void>
+        {
+            for (auto& slot : this->draw_lists)
+            {
+                slot.vertex_copies.clear();
+                slot.index_copies.clear();
+                slot.segment = &slot.list->acquire();
+
+                auto const& segment = *slot.segment;
+
+                if (segment.version == slot.uploaded[this->frame])
+                {
+                    continue;
+                }
+
+                const auto vertex_count = static_cast<ui32>(segment.vertices.size());
+                const auto index_count  = static_cast<ui32>(segment.indices.size());
+
+                if (vertex_count > slot.vertex_capacity || index_count > slot.index_capacity)
+                {
+                    if (auto res = this->grow_draw_list(slot, vertex_count, index_count); !res)
+                    {
+                        return res;
+                    }
+                }
+
+                auto gather = [&](std::vector<VkBufferCopy>& copies, std::span<const std::byte> bytes, VkDeviceSize slice) {
+                    if (bytes.empty())
+                    {
+                        return;
+                    }
+
+                    copies.push_back({
+                        .srcOffset = this->upload_scratch.size(),
+                        .dstOffset = slice * this->frame,
+                        .size      = bytes.size(),
+                    });
+
+                    this->upload_scratch.insert(this->upload_scratch.end(), bytes.begin(), bytes.end());
+                };
+
+                gather(slot.vertex_copies, std::as_bytes(std::span { segment.vertices }), slot.vertex_capacity * sizeof(vertex_t));
+                gather(slot.index_copies, std::as_bytes(std::span { segment.indices }), slot.index_capacity * sizeof(ui16));
+
+                slot.uploaded[this->frame] = segment.version;
+            }
+
+            return {};
+        }
+
+        auto grow_draw_list(draw_list_slot_t& slot, ui32 vertex_count, ui32 index_count) -> orb::result<void>
+        {
+            // Slices of frames in flight move with the capacity
+            if (slot.vertex_capacity != 0)
+            {
+                if (auto res = this->device->wait(); !res)
+                {
+                    return res;
+                }
+            }
+
+            const ui32 vertex_capacity = std::max({ vertex_count, slot.vertex_capacity * 2, 256u });
+            const ui32 index_capacity  = std::max({ index_count, slot.index_capacity * 2, 384u });
+
+            auto vertex_res = this->create_buffer(static_cast<VkDeviceSize>(vertex_capacity) * max_frames_in_flight * sizeof(vertex_t),
+                                                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+            if (!vertex_res)
+            {
+                return vertex_res.error();
+            }
+
+            auto index_res = this->create_buffer(static_cast<VkDeviceSize>(index_capacity) * max_frames_in_flight * sizeof(ui16),
+                                                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+
+            if (!index_res)
+            {
+                return index_res.error();
+            }
+
+            slot.vertices        = std::move(vertex_res.unwrap());
+            slot.indices         = std::move(index_res.unwrap());
+            slot.vertex_capacity = vertex_capacity;
+            slot.index_capacity  = index_capacity;
+            slot.uploaded        = {};
+
+            return {};
+        }
+
+        // Gathers the items written since last render. Nothing else about the
+        // sets goes through the CPU
+        void gather_instance_uploads()
+        {
+            for (auto& slot : this->instance_sets)
+            {
+                slot.copies.clear();
+
+                auto const pending = slot.set->pending();
+
+                for (auto const& upload : slot.set->uploads())
+                {
+                    auto const bytes = std::as_bytes(pending.subspan(upload.first_pending, upload.item_count));
+
+                    slot.copies.push_back({
+                        .srcOffset = this->upload_scratch.size(),
+                        .dstOffset = static_cast<VkDeviceSize>(upload.first_item) * sizeof(instance_item_t),
+                        .size      = bytes.size(),
+                    });
+
+                    this->upload_scratch.insert(this->upload_scratch.end(), bytes.begin(), bytes.end());
+                }
+
+                slot.set->clear_uploads();
+            }
+        }
+
+        // The culling pass reads this frame's clips from its own buffer,
+        // copied from the same staging range as the clip buffer
+        auto gather_culling_clips() -> orb::result<void>
+        {
+            this->culler_clip_copies.clear();
+
+            const auto count = static_cast<ui32>(this->frame_clips.size());
+
+            if (count > this->culler->clip_capacity())
+            {
+                if (auto res = this->device->wait(); !res)
+                {
+                    return res;
+                }
+
+                if (auto res = this->culler->reserve_clips(count); !res)
+                {
+                    return res.error();
+                }
+
+                for (auto const& slot : this->instance_sets)
+                {
+                    this->culler->bind_clips(slot.gpu);
+                }
+            }
+
+            this->culler_clip_copies.push_back({
+                .srcOffset = this->clip_copies.front().srcOffset,
+                .dstOffset = static_cast<VkDeviceSize>(this->frame) * this->culler->clip_capacity() * sizeof(clip_entry_t),
+                .size      = this->clip_copies.front().size,
+            });
+
+            const auto instance_clips = static_cast<ui32>(this->clips.entries().size());
+
+            for (auto& slot : this->instance_sets)
+            {
+                auto const& transform = slot.set->transform();
+                auto const& extent    = this->viewports[slot.set->viewport()]->extent;
+
+                slot.constants = {
+                    .scale        = transform.scale,
+                    .offset       = transform.offset,
+                    .extent       = { static_cast<f32>(extent.width), static_cast<f32>(extent.height) },
+                    .item_count   = slot.set->count(),
+                    .clip_count   = instance_clips,
+                    .visible_base = this->culler->visible_base(slot.gpu, this->frame),
+                    .command_base = this->culler->command_base(slot.gpu, this->frame),
+                    .clip_base    = this->frame * this->culler->clip_capacity(),
+                    .frame        = this->frame,
+                };
+            }
+
+            return {};
+        }
+
+        // Culls every set into this frame's visible lists and draws, once
+        // the uploads are visible to the compute stage
+        void record_culling(VkCommandBuffer cmd)
+        {
+            VkMemoryBarrier uploaded {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            };
+
+            vkCmdPipelineBarrier(cmd,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0,
+                                 1,
+                                 &uploaded,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+
+            for (auto const& slot : this->instance_sets)
+            {
+                this->culler->record_cull(cmd, slot.gpu, slot.constants);
+            }
+
+            VkMemoryBarrier culled {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+            };
+
+            vkCmdPipelineBarrier(cmd,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                                 0,
+                                 1,
+                                 &culled,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+        }
+
+        // Gathers the clips of this frame into its slice of the clip buffer,
+        // growing the buffer when they no longer fit
+        auto gather_clip_uploads() -> orb::result<void>
+        {
+            if (this->replay != nullptr)
+            {
+                this->frame_clips = this->replay->clips.empty() ? this->unclipped.entries() : this->replay->clips;
+            }
+            else if (this->draw_lists.empty())
+            {
+                this->frame_clips = this->clips.entries();
+            }
+            else
+            {
+                // Draw list clips follow the instance ones, rebased per list
+                auto const instance_clips = this->clips.entries();
+                this->merged_clips.assign(instance_clips.begin(), instance_clips.end());
+
+                for (auto& slot : this->draw_lists)
+                {
+                    auto const entries = slot.segment->clips.entries();
+
+                    slot.clip_base = static_cast<ui32>(this->merged_clips.size());
+                    this->merged_clips.insert(this->merged_clips.end(), entries.begin(), entries.end());
+                }
+
+                this->frame_clips = this->merged_clips;
+            }
+
+            if (this->replay == nullptr && this->capture)
+            {
+                this->capture->clips(this->frame_clips);
+            }
+
+            const auto count = static_cast<ui32>(this->frame_clips.size());
+
+            if (count > this->clip_capacity)
+            {
+                // Slices of frames in flight move with the capacity
+                if (this->clip_capacity != 0)
+                {
+                    if (auto res = this->device->wait(); !res)
+                    {
+                        return res;
+                    }
+                }
+
+                const ui32 capacity = std::max(count, std::max<ui32>(this->clip_capacity * 2, 64));
+
+                auto res = this->create_buffer(static_cast<VkDeviceSize>(capacity) * max_frames_in_flight * sizeof(clip_entry_t),
+                                               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+                if (!res)
+                {
+                    return res.error();
+                }
+
+                this->clip_buffer   = std::move(res.unwrap());
+                this->clip_capacity = capacity;
+            }
+
+            const auto bytes = std::as_bytes(this->frame_clips);
+
+            this->clip_copies.clear();
+            this->clip_copies.push_back({
+                .srcOffset = this->upload_scratch.size(),
+                .dstOffset = this->clip_offset(),
+                .size      = bytes.size(),
+            });
+
+            this->upload_scratch.insert(this->upload_scratch.end(), bytes.begin(), bytes.end());
+
+            return {};
+        }
+
+        [[nodiscard]] auto clip_offset() const -> VkDeviceSize
+        {
+            return static_cast<VkDeviceSize>(this->frame) * this->clip_capacity * sizeof(clip_entry_t);
+        }
+
+        // Gathers the node parameters of this frame into its slice of the node
+        // buffer. Animations only change this table, never the vertices
+        auto gather_node_uploads() -> orb::result<void>
+        {
+            if (this->replay != nullptr)
+            {
+                this->frame_nodes = this->replay->nodes.empty() ? std::span<const node_params_t> { untransformed } : this->replay->nodes;
+            }
+            else
+            {
+                this->frame_nodes = this->animator.params();
+
+                if (this->capture)
+                {
+                    this->capture->nodes(this->frame_nodes);
+                }
+            }
+
+            const auto count = static_cast<ui32>(this->frame_nodes.size());
+
+            if (count > this->node_capacity)
+            {
+                // The descriptor set is rewritten, no frame may still read it
+                if (this->node_capacity != 0)
+                {
+                    if (auto res = this->device->wait(); !res)
+                    {
+                        return res;
+                    }
+                }
+
+                const ui32 capacity = std::max(count, std::max<ui32>(this->node_capacity * 2, 64));
+
+                // Release first, so the pool can hand the range back
+                this->node_buffer = {};
+
+                auto res = this->create_buffer(static_cast<VkDeviceSize>(capacity) * max_frames_in_flight * sizeof(node_params_t),
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+                if (!res)
+                {
+                    return res.error();
+                }
+
+                this->node_buffer   = std::move(res.unwrap());
+                this->node_capacity = capacity;
+                this->pipeline->bind_nodes(this->node_buffer.handle());
+            }
+
+            const auto bytes = std::as_bytes(this->frame_nodes);
+
+            this->node_copies.clear();
+            this->node_copies.push_back({
+                .srcOffset = this->upload_scratch.size(),
+                .dstOffset = static_cast<VkDeviceSize>(this->frame) * this->node_capacity * sizeof(node_params_t),
+                .size      = bytes.size(),
+            });
+
+            this->upload_scratch.insert(this->upload_scratch.end(), bytes.begin(), bytes.end());
+
+            return {};
+        }
+
+        [[nodiscard]] auto node_constants() const -> gui_constants_t
+        {
+            return {
+                .node_base  = this->frame * this->node_capacity,
+                .node_count = static_cast<ui32>(this->frame_nodes.size()),
+            };
+        }
+
+        // Gathers this frame's uploads into its staging buffer and records
+        // their copies into `cmd`
+        auto record_uploads(VkCommandBuffer cmd) -> orb::result<void>
+        {
+            this->upload_scratch.clear();
+
+            if (this->replay != nullptr)
+            {
+                if (auto res = this->gather_replay_uploads(); !res)
+                {
+                    return res;
+                }
+            }
+            else
+            {
+                this->gather_plot_uploads();
+                this->gather_instance_uploads();
+
+                if (auto res = this->gather_draw_list_uploads(); !res)
+                {
+                    return res;
+                }
+            }
+
+            if (auto res = this->gather_clip_uploads(); !res)
+            {
+                return res;
+            }
+
+            if (auto res = this->gather_node_uploads(); !res)
+            {
+                return res;
+            }
+
+            // Replays hold no instance sets, they are not captured
+            const bool culling = this->replay == nullptr && !this->instance_sets.empty();
+
+            if (culling)
+            {
+                if (auto res = this->gather_culling_clips(); !res)
+                {
+                    return res;
+                }
+            }
+
+            const VkDeviceSize size = this->upload_scratch.size();
+
+            if (this->staging.size() < max_frames_in_flight)
+            {
+                this->staging.resize(max_frames_in_flight);
+            }
+
+            if (this->staging[this->frame].size() < size)
+            {
+                // Grow geometrically so a steady stream settles on one allocation
+                const VkDeviceSize new_size = std::max(size, this->staging[this->frame].size() * 2);
+
+                // Release first, so the pool can hand the range back
+                this->staging[this->frame] = {};
+
+                auto res = this->create_staging(new_size);
+
+                if (!res)
+                {
+                    return res.error();
+                }
+
+                this->staging[this->frame] = std::move(res.unwrap());
+            }
+
+            auto& staging_buffer = this->staging[this->frame];
+
+            if (size != 0)
+            {
+                std::memcpy(staging_buffer.mapped(), this->upload_scratch.data(), size);
+            }
+
+            auto copy = [&](VkBuffer dst, std::vector<VkBufferCopy> const& copies) {
+                if (!copies.empty())
+                {
+                    vkCmdCopyBuffer(cmd, staging_buffer.handle(), dst, static_cast<ui32>(copies.size()), copies.data());
+                }
+            };
+
+            // Plot and replay buffers are not sliced per frame, the previous
+            // frame may still be reading what the copies overwrite
+            bool overwrite = false;
+
+            if (this->replay != nullptr)
+            {
+                for (auto const& [id, buffer] : this->replay_buffers)
+                {
+                    overwrite = overwrite || !buffer.copies.empty();
+                }
+            }
+            else
+            {
+                for (auto const& slot : this->plots)
+                {
+                    overwrite = overwrite || !slot.copies.empty();
+                }
+            }
+
+            VkPipelineStageFlags readers = 0;
+
+            if (overwrite)
+            {
+                readers |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+            }
+
+            // Items and clips may still be read by the previous frame
+            if (culling)
+            {
+                readers |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+            }
+
+            if (readers != 0)
+            {
+                vkCmdPipelineBarrier(cmd,
+                                     readers,
+                                     VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     0,
+                                     0,
+                                     nullptr,
+                                     0,
+                                     nullptr,
+                                     0,
+                                     nullptr);
+            }
+
+            if (culling)
+            {
+                for (auto const& slot : this->instance_sets)
+                {
+                    copy(slot.gpu.items.handle(), slot.copies);
+                    this->culler->record_reset(cmd, slot.gpu, this->frame);
+                }
+
+                copy(this->culler->clip_buffer(), this->culler_clip_copies);
+            }
+
+            if (this->replay != nullptr)
+            {
+                for (auto const& [id, buffer] : this->replay_buffers)
+                {
+                    copy(buffer.buffer.handle(), buffer.copies);
+                }
+            }
+            else
+            {
+                for (auto const& slot : this->plots)
+                {
+                    copy(slot.vertices.handle(), slot.copies);
+                }
+
+                for (auto const& slot : this->draw_lists)
+                {
+                    copy(slot.vertices.handle(), slot.vertex_copies);
+                    copy(slot.indices.handle(), slot.index_copies);
+                }
+            }
+
+            copy(this->clip_buffer.handle(), this->clip_copies);
+            copy(this->node_buffer.handle(), this->node_copies);
+
+            VkMemoryBarrier barrier {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+            };
+
+            vkCmdPipelineBarrier(cmd,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                                 0,
+                                 1,
+                                 &barrier,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+
+            if (culling)
+            {
+                this->record_culling(cmd);
+            }
+
+            return {};
+        }
+
+        // Records the queued draws. Runs of draws sharing a rectangular clip
+        // may use a scissor, `scissor` being the one to restore afterwards
+        void record_queued_draws(VkCommandBuffer cmd, VkRect2D const& scissor)
+        {
+            std::array<VkDeviceSize, 1> offsets  = { 0 };
+            VkBuffer                    vertices = VK_NULL_HANDLE;
+            VkBuffer                    indices  = VK_NULL_HANDLE;
+
+            auto const& draws = this->queued_draws;
+
+            for (size_t i = 0; i < draws.size();)
+            {
+                size_t run_end = i + 1;
+
+                while (run_end < draws.size() && draws[run_end].clip == draws[i].clip)
+                {
+                    ++run_end;
+                }
+
+                // Unknown clips fall back to the unclipped root
+                const ui32  clip  = draws[i].clip < this->frame_clips.size() ? draws[i].clip : clip_stack_t::no_clip;
+                auto const& entry = this->frame_clips[clip];
+
+                const bool use_scissor = clip != clip_stack_t::no_clip
+                                      && entry.radius == 0.0f
+                                      && run_end - i >= scissor_min_draws;
+
+                if (use_scissor)
+                {
+                    const auto clipped = clip_scissor(entry, scissor);
+                    vkCmdSetScissor(cmd, 0, 1, &clipped);
+                }
+
+                for (; i < run_end; ++i)
+                {
+                    auto const& draw = draws[i];
+
+                    if (draw.vertices != vertices)
+                    {
+                        vertices = draw.vertices;
+                        vkCmdBindVertexBuffers(cmd, 0, 1, &vertices, offsets.data());
+                    }
+
+                    if (draw.indices != indices)
+                    {
+                        indices = draw.indices;
+                        vkCmdBindIndexBuffer(cmd, indices, 0, draw.index_type);
+                    }
+
+                    vkCmdDrawIndexed(cmd, draw.index_count, 1, draw.first_index, draw.vertex_offset, clip);
+                }
+
+                if (use_scissor)
+                {
+                    vkCmdSetScissor(cmd, 0, 1, &scissor);
+                }
+            }
+        }
+
+        void record_plot_draws(VkCommandBuffer cmd, ui32 viewport, VkRect2D const& scissor)
+        {
+            this->queued_draws.clear();
+
+            for (ui32 i = 0; i < this->plots.size(); ++i)
+            {
+                auto const& slot = this->plots[i];
+
+                if (slot.viewport != viewport)
+                {
+                    continue;
+                }
+
+                for (auto const& draw : slot.plot->draws())
+                {
+                    this->queued_draws.push_back({
+                        .vertices      = slot.vertices.handle(),
+                        .indices       = this->band_indices.handle(),
+                        .index_type    = VK_INDEX_TYPE_UINT16,
+                        .first_index   = draw.first_index,
+                        .index_count   = draw.index_count,
+                        .vertex_offset = draw.vertex_offset,
+                        .clip          = draw.clip,
+                    });
+
+                    if (this->capture)
+                    {
+                        this->capture->draw({
+                            .vertex_buffer = capture_first_plot + i,
+                            .index_buffer  = capture_band_indices,
+                            .first_index   = draw.first_index,
+                            .index_count   = draw.index_count,
+                            .vertex_offset = draw.vertex_offset,
+                            .clip          = draw.clip,
+                        });
+                    }
+                }
+            }
+
+            this->record_queued_draws(cmd, scissor);
+        }
+
+        // Draws the survivors of the viewport's sets, then restores the main pipeline
+        void record_instance_draws(VkCommandBuffer cmd, ui32 viewport)
+        {
+            bool drawn = false;
+
+            for (auto const& slot : this->instance_sets)
+            {
+                if (slot.set->viewport() != viewport || slot.set->count() == 0)
+                {
+                    continue;
+                }
+
+                if (!drawn)
+                {
+                    vkCmdBindIndexBuffer(cmd, this->index_buffer.handle(), 0, VK_INDEX_TYPE_UINT16);
+                    drawn = true;
+                }
+
+                this->culler->record_draw(cmd, slot.gpu, slot.constants, this->frame);
+            }
+
+            if (drawn)
+            {
+                this->pipeline->record_bind(cmd, this->node_constants());
+            }
+        }
+
+        // Merges the commands of the viewport's draw lists by layer, ties going
+        // to the oldest list, so the order never depends on producer timing
+        void record_draw_list_draws(VkCommandBuffer cmd, ui32 viewport, VkRect2D const& scissor)
+        {
+            auto& cursors = this->draw_cursors;
+
+            cursors.clear();
+
+            for (auto const& slot : this->draw_lists)
+            {
+                if (slot.viewport == viewport && !slot.segment->commands.empty())
+                {
+                    cursors.push_back({ .slot = &slot, .next = 0 });
+                }
+            }
+
+            this->queued_draws.clear();
+
+            while (!cursors.empty())
+            {
+                // Lists are few, a linear scan beats a heap
+                size_t best = 0;
+
+                for (size_t i = 1; i < cursors.size(); ++i)
+                {
+                    auto const& a = cursors[i].slot->segment->commands[cursors[i].next];
+                    auto const& b = cursors[best].slot->segment->commands[cursors[best].next];
+
+                    best = a.layer < b.layer ? i : best;
+                }
+
+                auto&       cursor  = cursors[best];
+                auto const& slot    = *cursor.slot;
+                auto const& command = slot.segment->commands[cursor.next++];
+
+                if (command.index_count != 0)
+                {
+                    this->queued_draws.push_back({
+                        .vertices      = slot.vertices.handle(),
+                        .indices       = slot.indices.handle(),
+                        .index_type    = VK_INDEX_TYPE_UINT16,
+                        .first_index   = slot.index_capacity * this->frame + command.first_index,
+                        .index_count   = command.index_count,
+                        .vertex_offset = static_cast<i32>(slot.vertex_capacity * this->frame) + command.vertex_offset,
+                        .clip          = slot.clip_base + command.clip,
+                    });
+                }
+
+                // Erasing keeps the remaining cursors in list order for the ties
+                if (cursor.next == slot.segment->commands.size())
+                {
+                    cursors.erase(cursors.begin() + static_cast<std::ptrdiff_t>(best));
+                }
+            }
+
+            this->record_queued_draws(cmd, scissor);
+        }
+
+        void record_replay_draws(VkCommandBuffer cmd, ui32 viewport)
+        {
+            for (auto const& pass : this->replay->passes)
+            {
+                if (pass.viewport.viewport != viewport)
+                {
+                    continue;
+                }
+
+                const VkRect2D scissor {
+                    .offset = { pass.viewport.scissor_x, pass.viewport.scissor_y },
+                    .extent = { pass.viewport.scissor_width, pass.viewport.scissor_height },
+                };
+
+                vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+                this->queued_draws.clear();
+
+                for (auto const& draw : pass.draws)
+                {
+                    auto vertices = this->replay_buffers.find(draw.vertex_buffer);
+                    auto indices  = this->replay_buffers.find(draw.index_buffer);
+
+                    if (vertices == this->replay_buffers.end() || indices == this->replay_buffers.end())
+                    {
+                        continue;
+                    }
+
+                    // Out of range draws would read past the device buffers
+                    if (!this->replay_draw_in_range(draw, vertices->second, indices->second))
+                    {
+                        continue;
+                    }
+
+                    this->queued_draws.push_back({
+                        .vertices      = vertices->second.buffer.handle(),
+                        .indices       = indices->second.buffer.handle(),
+                        .index_type    = VK_INDEX_TYPE_UINT16,
+                        .first_index   = draw.first_index,
+                        .index_count   = draw.index_count,
+                        .vertex_offset = draw.vertex_offset,
+                        .clip          = draw.clip,
+                    });
+                }
+
+                this->record_queued_draws(cmd, scissor);
+            }
+        }
+
+        // The draw's indices lie in the index buffer and the vertices they
+        // reference, offset included, in the vertex buffer
+        static auto replay_draw_in_range(capture_draw_t const& draw, replay_buffer_t const& vertices, replay_buffer_t const& indices) -> bool
+        {
+            if (vertices.usage != capture_buffer_usage::vertex || indices.usage != capture_buffer_usage::index)
+            {
+                return false;
+            }
+
+            auto const& index_data = indices.indices;
+
+            if (draw.first_index > index_data.size() || draw.index_count > index_data.size() - draw.first_index)
+            {
+                return false;
+            }
+
+            if (draw.index_count == 0)
             {
-                return res.error();
+                return true;
             }
 
-            this->fbs = std::move(res.unwrap());
+            const auto range    = std::span { index_data }.subspan(draw.first_index, draw.index_count);
+            const i64  smallest = static_cast<i64>(*std::ranges::min_element(range)) + draw.vertex_offset;
+            const i64  largest  = static_cast<i64>(*std::ranges::max_element(range)) + draw.vertex_offset;
+
+            return smallest >= 0 && static_cast<ui64>(largest) < vertices.size / sizeof(vertex_t);
+        }
+
+        // Creates the device buffers a replayed frame declares
+        auto create_replay_buffers(replay_frame_t const& frame) -> orb::result<void>
+        {
+            for (auto const& create : frame.creates)
+            {
+                auto& buffer = this->replay_buffers[create.buffer];
+
+                if (buffer.size == create.size && buffer.usage == create.usage)
+                {
+                    continue;
+                }
+
+                // The previous buffer may still be read by frames in flight
+                if (buffer.size != 0)
+                {
+                    if (auto res = this->device->wait(); !res)
+                    {
+                        return res;
+                    }
+                }
+
+                buffer.usage  = create.usage;
+                buffer.size   = create.size;
+                buffer.buffer = {};
+                buffer.indices.clear();
+
+                if (create.usage == capture_buffer_usage::index)
+                {
+                    buffer.indices.resize((create.size + 1) / sizeof(ui16));
+                }
+
+                const VkBufferUsageFlags usage = create.usage == capture_buffer_usage::vertex
+                                                   ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                                                   : VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+                auto res = this->create_buffer(std::max<VkDeviceSize>(create.size, 1), usage);
+
+                if (!res)
+                {
+                    return res.error();
+                }
+
+                buffer.buffer = std::move(res.unwrap());
+            }
 
             return {};
-        };
+        }
 
-        void render()
+        // Records the draws of one viewport into its command buffer for this frame
+        auto record_viewport(ui32 index) -> VkCommandBuffer
         {
+            auto& vp = this->viewports[index];
+
             // Render to the framebuffer
-            this->render_pass->begin_info.framebuffer       = this->fbs.handles[this->frame];
-            this->render_pass->begin_info.renderArea.extent = this->extent;
+            this->render_pass->begin_info.framebuffer       = vp->fbs.handles[this->frame];
+            this->render_pass->begin_info.renderArea.extent = vp->extent;
 
             // Begin command buffer recording
-            auto cmd = this->draw_cmds.get(this->frame).unwrap();
+            auto cmd = vp->draw_cmds.get(this->frame).unwrap();
             cmd.begin_one_time().unwrap();
 
             // Begin the render pass
             this->render_pass->begin(cmd.handle);
 
-            // Bind the graphics pipeline
-            vkCmdBindPipeline(cmd.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, this->pipeline->handle);
+            // Bind the graphics pipeline and this frame's node parameters
+            this->pipeline->record_bind(cmd.handle, this->node_constants());
             std::array<VkDeviceSize, 1> offsets = { 0 };
-            vkCmdBindVertexBuffers(cmd.handle, 0, 1, &this->vertex_buffer.buffer, offsets.data());
-            vkCmdBindIndexBuffer(cmd.handle, this->index_buffer.buffer, 0, this->index_buffer.index_type);
+            const VkBuffer              quad    = this->vertex_buffer.handle();
+            vkCmdBindVertexBuffers(cmd.handle, 0, 1, &quad, offsets.data());
+            vkCmdBindIndexBuffer(cmd.handle, this->index_buffer.handle(), 0, VK_INDEX_TYPE_UINT16);
+
+            // Clips of this frame, indexed by the first instance of each draw
+            const VkDeviceSize clip_offset = this->clip_offset();
+            const VkBuffer     clip_data   = this->clip_buffer.handle();
+            vkCmdBindVertexBuffers(cmd.handle, 1, 1, &clip_data, &clip_offset);
 
             // Set viewport and scissor
-            auto& viewport        = this->pipeline->viewports.back();
-            auto& scissor         = this->pipeline->scissors.back();
-            viewport.width        = static_cast<f32>(this->extent.width);
-            viewport.height       = static_cast<f32>(this->extent.height);
-            scissor.extent.width  = this->extent.width;
-            scissor.extent.height = this->extent.height;
+            const VkViewport viewport {
+                .x        = 0.0f,
+                .y        = 0.0f,
+                .width    = static_cast<f32>(vp->extent.width),
+                .height   = static_cast<f32>(vp->extent.height),
+                .minDepth = 0.0f,
+                .maxDepth = 1.0f,
+            };
+
+            const VkRect2D scissor { .offset = { 0, 0 }, .extent = vp->extent };
             vkCmdSetViewport(cmd.handle, 0, 1, &viewport);
             vkCmdSetScissor(cmd.handle, 0, 1, &scissor);
 
-            // Draw quad
-            vkCmdDrawIndexed(cmd.handle, 6, 1, 0, 0, 0);
+            if (this->replay != nullptr)
+            {
+                this->record_replay_draws(cmd.handle, index);
+            }
+            else
+            {
+                if (this->capture)
+                {
+                    this->capture->viewport({
+                        .viewport       = index,
+                        .width          = vp->extent.width,
+                        .height         = vp->extent.height,
+                        .scissor_x      = scissor.offset.x,
+                        .scissor_y      = scissor.offset.y,
+                        .scissor_width  = scissor.extent.width,
+                        .scissor_height = scissor.extent.height,
+                    });
+
+                    this->capture->draw({
+                        .vertex_buffer = capture_quad_vertices,
+                        .index_buffer  = capture_quad_indices,
+                        .first_index   = 0,
+                        .index_count   = 6,
+                        .vertex_offset = 0,
+                        .clip          = clip_stack_t::no_clip,
+                    });
+                }
+
+                // Draw quad
+                vkCmdDrawIndexed(cmd.handle, 6, 1, 0, 0, 0);
+
+                // Plots, then instance sets, then draw lists on top
+                this->record_plot_draws(cmd.handle, index, scissor);
+                this->record_instance_draws(cmd.handle, index);
+                this->record_draw_list_draws(cmd.handle, index, scissor);
+            }
 
             // End the render pass
             this->render_pass->end(cmd.handle);
@@ -151,16 +1569,10 @@ namespace orb::gui
             // End command buffer recording
             cmd.end().unwrap();
 
-            this->finished = this->render_finished.view(this->frame, 1);
-
-            // Submit render
-            vk::submit_helper_t::prepare()
-                .signal_semaphores(this->finished.handles)
-                .cmd_buffer(&cmd.handle)
-                .submit(this->graphics_queue)
-                .unwrap();
+            vp->finished = vp->render_finished.view(this->frame, 1);
+            vp->rendered = this->frame;
 
-            frame = (frame + 1) % max_frames_in_flight;
+            return cmd.handle;
         }
     };
 
@@ -168,16 +1580,34 @@ namespace orb::gui
 
     auto instance_t::create(instance_create_info_t&& info) -> orb::result<instance_t>
     {
-        auto r = make_box<gui_renderer_t>();
+        if (info.gpu == VK_NULL_HANDLE)
+        {
+            return orb::error_t { "GUI instance creation needs the device's GPU" };
+        }
 
-        r->device         = info.device;
-        r->graphics_queue = info.graphics_queue;
-        r->transfer_queue = info.transfer_queue;
+        // Budget queries are only valid with the extension enabled on the device
+        const bool memory_budget = std::ranges::any_of(info.device_extensions, [](char const* name) {
+            return std::string_view { name } == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+        });
 
-        r->extent = {
-            .width  = info.extent_width,
-            .height = info.extent_height,
-        };
+        auto pools = memory_pools_t::acquire(info.device->handle, info.gpu, memory_budget);
+
+        if (!pools)
+        {
+            return pools.error();
+        }
+
+        auto r = make_box<gui_renderer_t>();
+
+        r->device              = info.device;
+        r->pools               = std::move(pools.unwrap());
+        r->graphics_queue      = info.graphics_queue;
+        r->transfer_queue      = info.transfer_queue;
+        r->gpu                 = info.gpu;
+        r->shader_dir          = info.shader_dir;
+        r->multi_draw_indirect = info.multi_draw_indirect;
+        r->draw_indirect_count = info.draw_indirect_count;
+        r->epoch               = frame_clock_t::now();
 
         r->attachments.add({
             .img_format        = vkenum(vk::format::b8g8r8a8_unorm),
@@ -213,10 +1643,8 @@ namespace orb::gui
                              .build(r->subpasses, r->attachments)
                              .unwrap();
 
-        r->create_surfaces();
-
-        const path vs_path { "/home/lucla/work/OrbGui/samples/minimal/main.vs.glsl" };
-        const path fs_path { "/home/lucla/work/OrbGui/samples/minimal/main.fs.glsl" };
+        const path vs_path { (info.shader_dir / "main.vs.glsl").string() };
+        const path fs_path { (info.shader_dir / "main.fs.glsl").string() };
 
         vk::spirv_compiler_t compiler;
         compiler.option_target_env(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2)
@@ -247,40 +1675,11 @@ namespace orb::gui
                                   .build()
                                   .unwrap();
 
-        struct vertex_t
-        {
-            std::array<float, 2> pos;
-            std::array<float, 3> col;
-        };
-
         fmt::println("- Creating graphics pipeline");
-        r->pipeline = vk::pipeline_builder_t ::prepare(info.device)
-                          .unwrap()
-                          ->shader_stages()
-                          .stage(r->vs_shader_module, vk::shader_stage_flag::vertex, "main")
-                          .stage(r->fs_shader_module, vk::shader_stage_flag::fragment, "main")
-                          .dynamic_states()
-                          .dynamic_state(vk::dynamic_state::viewport)
-                          .dynamic_state(vk::dynamic_state::scissor)
-                          .vertex_input()
-                          .binding<vertex_t>(0, vk::vertex_input_rate::vertex)
-                          .attribute(0, offsetof(vertex_t, pos), vk::vertex_format::vec2_t)
-                          .attribute(1, offsetof(vertex_t, col), vk::vertex_format::vec3_t)
-                          .input_assembly()
-                          .viewport_states()
-                          .viewport(0.0f, 0.0f, (f32)r->extent.width, (f32)r->extent.height, 0.0f, 1.0f)
-                          .scissor(0.0f, 0.0f, r->extent.width, r->extent.height)
-                          .rasterizer()
-                          .multisample()
-                          .color_blending()
-                          .new_color_blend_attachment()
-                          .end_attachment()
-                          .desc_set_layout()
-                          .pipeline_layout()
-                          .prepare_pipeline()
-                          .render_pass(r->render_pass.getmut())
-                          .subpass(0)
-                          .build()
+        r->pipeline = gui_pipeline_t::create(info.device->handle,
+                                             r->render_pass->handle,
+                                             r->vs_shader_module.handle,
+                                             r->fs_shader_module.handle)
                           .unwrap();
 
         fmt::println("- Creating command pool and command buffers");
@@ -297,7 +1696,28 @@ namespace orb::gui
                                    .unwrap();
 
         fmt::println("- Creating command buffers");
-        r->draw_cmds = r->graphics_cmd_pool->alloc_cmds(max_frames_in_flight).unwrap();
+        r->upload_cmds = r->graphics_cmd_pool->alloc_cmds(max_frames_in_flight).unwrap();
+
+        if (info.timestamp_period > 0.0f)
+        {
+            fmt::println("- Creating timestamp queries");
+            VkQueryPoolCreateInfo query_info {
+                .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = max_frames_in_flight * 2,
+            };
+
+            if (auto res = vkCreateQueryPool(info.device->handle, &query_info, nullptr, &r->timestamps); res != VK_SUCCESS)
+            {
+                return orb::error_t { "Timestamp query pool creation error: {}", vk::vkres::get_repr(res) };
+            }
+
+            r->timestamp_period = info.timestamp_period;
+            r->timestamp_cmds   = r->graphics_cmd_pool->alloc_cmds(max_frames_in_flight).unwrap();
+        }
+
+        fmt::println("- Creating main viewport");
+        r->create_viewport(info.extent_width, info.extent_height).unwrap();
 
         std::vector<vertex_t> vertices = {
             { { -0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f } },
@@ -308,132 +1728,324 @@ namespace orb::gui
 
         std::vector<ui16> indices = { 0, 1, 2, 2, 3, 0 };
 
+        const VkDeviceSize vertex_bytes = sizeof(vertex_t) * vertices.size();
+        const VkDeviceSize index_bytes  = sizeof(ui16) * indices.size();
+
         fmt::println("- Creating vertex buffer");
-        r->vertex_buffer = vk::vertex_buffer_builder_t::prepare(info.device)
-                               .unwrap()
-                               .vertices(vertices)
-                               .buffer_usage_flag(vk::buffer_usage_flag::transfer_destination)
-                               .memory_flags(vk::memory_flag::dedicated_memory)
-                               .build()
-                               .unwrap();
+        r->vertex_buffer = r->create_buffer(vertex_bytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT).unwrap();
 
         fmt::println("- Creating index buffer");
-        r->index_buffer = vk::index_buffer_builder_t::prepare(info.device)
-                              .unwrap()
-                              .indices(std::span<const ui16> { indices })
-                              .buffer_usage_flag(vk::buffer_usage_flag::transfer_destination)
-                              .memory_flags(vk::memory_flag::dedicated_memory)
-                              .build()
-                              .unwrap();
-
-        fmt::println("- Creating staging buffer");
-        auto staging_buffer = vk::staging_buffer_builder_t::prepare(info.device, r->vertex_buffer.size)
-                                  .unwrap()
-                                  .build()
-                                  .unwrap();
+        r->index_buffer = r->create_buffer(index_bytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT).unwrap();
+
+        fmt::println("- Copying vertices to vertex buffer");
+        r->upload_now(r->vertex_buffer.handle(), vertices.data(), vertex_bytes).unwrap();
 
-        fmt::println("- Copying vertices to staging buffer");
-        staging_buffer.transfer(vertices.data(), sizeof(vertex_t) * vertices.size()).unwrap();
+        fmt::println("- Copying indices to index buffer");
+        r->upload_now(r->index_buffer.handle(), indices.data(), index_bytes).unwrap();
 
-        fmt::println("- Copying staging buffer to vertex buffer");
-        auto cpy_cmd = r->transfer_cmd_pool->alloc_cmds(1).unwrap().get(0).unwrap();
+        // Kept for captures, which start with the content of every buffer
+        r->quad_vertices = std::move(vertices);
+        r->quad_indices  = std::move(indices);
 
-        cpy_cmd.begin_one_time().unwrap();
-        cpy_cmd.copy_buffer(staging_buffer.buffer, r->vertex_buffer.buffer, r->vertex_buffer.size);
-        cpy_cmd.end().unwrap();
+        return instance_t { std::move(r) };
+    }
+
+    auto instance_t::render() -> orb::result<void>
+    {
+        auto& r = this->m_renderer;
 
-        fmt::println("- Submitting copy command buffer");
-        vk::submit_helper_t::prepare()
-            .cmd_buffer(&cpy_cmd.handle)
-            .submit(info.transfer_queue)
-            .unwrap();
+        r->collect_timings();
 
-        info.device->wait().unwrap();
+        if (!r->latched)
+        {
+            r->latch = frame_clock_t::now();
+        }
 
-        fmt::println("- Copying indices to staging buffer");
-        staging_buffer.transfer(indices.data(), sizeof(ui16) * indices.size()).unwrap();
+        // Animations advance once per frame, at the input time
+        r->animator.evaluate(to_ms(r->latch - r->epoch));
 
-        fmt::println("- Copying staging buffer to index buffer");
-        cpy_cmd = r->transfer_cmd_pool->alloc_cmds(1).unwrap().get(0).unwrap();
+        // Uploads are shared by all the viewports and recorded once
+        auto upload_cmd = r->upload_cmds.get(r->frame).unwrap();
+        upload_cmd.begin_one_time().unwrap();
 
-        cpy_cmd.begin_one_time().unwrap();
-        cpy_cmd.copy_buffer(staging_buffer.buffer, r->index_buffer.buffer, r->index_buffer.size);
-        cpy_cmd.end().unwrap();
+        if (r->timestamps != VK_NULL_HANDLE)
+        {
+            vkCmdResetQueryPool(upload_cmd.handle, r->timestamps, r->frame * 2, 2);
+            vkCmdWriteTimestamp(upload_cmd.handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, r->timestamps, r->frame * 2);
+        }
 
-        fmt::println("- Submitting copy command buffer");
-        vk::submit_helper_t::prepare()
-            .cmd_buffer(&cpy_cmd.handle)
-            .submit(info.transfer_queue)
-            .unwrap();
+        // Captures never include replayed frames
+        const bool capturing = r->capture && r->replay == nullptr;
 
-        info.device->wait().unwrap();
+        if (capturing)
+        {
+            r->capture->begin_frame(r->frame_number);
 
-        fmt::println("- Creating render finished semaphores");
-        r->render_finished = vk::semaphores_builder_t::prepare(info.device)
-                                 .unwrap()
-                                 .count(max_frames_in_flight)
-                                 .stage(vk::pipeline_stage_flag::transfer)
-                                 .build()
-                                 .unwrap();
+            if (r->capture_resources_pending)
+            {
+                r->capture_resources();
+            }
+        }
 
-        return instance_t { std::move(r) };
+        // Upload the plot columns covered by new samples
+        if (auto res = r->record_uploads(upload_cmd.handle); !res)
+        {
+            return res;
+        }
+
+        upload_cmd.end().unwrap();
+
+        r->submit_cmds.assign(1, upload_cmd.handle);
+        r->submit_signals.clear();
+
+        for (ui32 i = 0; i < r->viewports.size(); ++i)
+        {
+            r->submit_cmds.push_back(r->record_viewport(i));
+
+            for (auto semaphore : r->viewports[i]->finished.handles)
+            {
+                r->submit_signals.push_back(semaphore);
+            }
+        }
+
+        if (r->timestamps != VK_NULL_HANDLE)
+        {
+            auto timestamp_cmd = r->timestamp_cmds.get(r->frame).unwrap();
+            timestamp_cmd.begin_one_time().unwrap();
+            vkCmdWriteTimestamp(timestamp_cmd.handle, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, r->timestamps, r->frame * 2 + 1);
+            timestamp_cmd.end().unwrap();
+
+            r->submit_cmds.push_back(timestamp_cmd.handle);
+        }
+
+        // Submit every viewport in one batch, the upload barrier orders them
+        // after the shared uploads
+        VkSubmitInfo submit_info {
+            .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount   = static_cast<ui32>(r->submit_cmds.size()),
+            .pCommandBuffers      = r->submit_cmds.data(),
+            .signalSemaphoreCount = static_cast<ui32>(r->submit_signals.size()),
+            .pSignalSemaphores    = r->submit_signals.data(),
+        };
+
+        if (auto res = vkQueueSubmit(r->graphics_queue, 1, &submit_info, VK_NULL_HANDLE); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Render submit error: {}", vk::vkres::get_repr(res) };
+        }
+
+        r->timings[r->frame] = {
+            .frame_number = r->frame_number++,
+            .latch        = r->latch,
+            .submit       = frame_clock_t::now(),
+            .pending      = true,
+        };
+
+        if (capturing)
+        {
+            r->capture->end_frame();
+        }
+
+        r->latched = false;
+        r->frame   = (r->frame + 1) % max_frames_in_flight;
+        return {};
     }
 
-    auto instance_t::render() -> orb::result<void>
+    auto instance_t::render_replay(replay_frame_t const& frame) -> orb::result<void>
+    {
+        auto& r = this->m_renderer;
+
+        if (auto res = r->create_replay_buffers(frame); !res)
+        {
+            return res;
+        }
+
+        r->replay = &frame;
+        auto res  = this->render();
+        r->replay = nullptr;
+
+        return res;
+    }
+
+    auto instance_t::begin_capture(std::filesystem::path const& file) -> orb::result<void>
     {
-        // Render to the framebuffer
-        auto& r                                      = this->m_renderer;
-        r->render_pass->begin_info.framebuffer       = r->fbs.handles[r->frame];
-        r->render_pass->begin_info.renderArea.extent = r->extent;
-
-        // Begin command buffer recording
-        auto cmd = r->draw_cmds.get(r->frame).unwrap();
-        cmd.begin_one_time().unwrap();
-
-        // Begin the render pass
-        r->render_pass->begin(cmd.handle);
-
-        // Bind the graphics pipeline
-        vkCmdBindPipeline(cmd.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, r->pipeline->handle);
-        std::array<VkDeviceSize, 1> offsets = { 0 };
-        vkCmdBindVertexBuffers(cmd.handle, 0, 1, &r->vertex_buffer.buffer, offsets.data());
-        vkCmdBindIndexBuffer(cmd.handle, r->index_buffer.buffer, 0, r->index_buffer.index_type);
-
-        // Set viewport and scissor
-        auto& viewport        = r->pipeline->viewports.back();
-        auto& scissor         = r->pipeline->scissors.back();
-        viewport.width        = static_cast<f32>(r->extent.width);
-        viewport.height       = static_cast<f32>(r->extent.height);
-        scissor.extent.width  = r->extent.width;
-        scissor.extent.height = r->extent.height;
-        vkCmdSetViewport(cmd.handle, 0, 1, &viewport);
-        vkCmdSetScissor(cmd.handle, 0, 1, &scissor);
-
-        // Draw quad
-        vkCmdDrawIndexed(cmd.handle, 6, 1, 0, 0, 0);
-
-        // End the render pass
-        r->render_pass->end(cmd.handle);
-
-        // End command buffer recording
-        cmd.end().unwrap();
-
-        r->finished = r->render_finished.view(r->frame, 1);
-
-        // Submit render
-        vk::submit_helper_t::prepare()
-            .signal_semaphores(r->finished.handles)
-            .cmd_buffer(&cmd.handle)
-            .submit(r->graphics_queue)
-            .unwrap();
-
-        r->frame = (r->frame + 1) % max_frames_in_flight;
+        auto& r = this->m_renderer;
+
+        if (auto res = this->end_capture(); !res)
+        {
+            return res;
+        }
+
+        // The capture format has no records for them, replays would silently miss them
+        if (!r->draw_lists.empty() || !r->instance_sets.empty())
+        {
+            return orb::error_t { "Captures cannot record draw lists or instance sets, {} and {} exist",
+                                  r->draw_lists.size(),
+                                  r->instance_sets.size() };
+        }
+
+        auto writer = capture_writer_t::create(file);
+
+        if (!writer)
+        {
+            return writer.error();
+        }
+
+        r->capture.emplace(std::move(writer.unwrap()));
+        r->capture_resources_pending = true;
+
         return {};
     }
 
+    auto instance_t::end_capture() -> orb::result<void>
+    {
+        auto& r = this->m_renderer;
+
+        if (!r->capture)
+        {
+            return {};
+        }
+
+        auto res = r->capture->finish();
+        r->capture.reset();
+
+        return res;
+    }
+
+    void instance_t::wait_input_latch()
+    {
+        auto& r = this->m_renderer;
+
+        if (r->pacing.mode == pacing_mode::low_latency)
+        {
+            using ms_t = std::chrono::duration<f64, std::milli>;
+
+            const auto now    = frame_clock_t::now();
+            const auto period = std::chrono::duration_cast<frame_clock_t::duration>(ms_t(r->pacing.frame_period_ms));
+
+            // Deadlines advance by whole periods so sleeps do not drift with the
+            // fence wait, a missed one re-anchors on now instead of catching up
+            r->next_deadline += period;
+
+            if (r->next_deadline <= now)
+            {
+                r->next_deadline = now + period;
+            }
+
+            // Leave just enough time to build, submit and render before the deadline
+            const f64 budget_ms = r->gpu_ms.max() + r->cpu_ms.max() + r->pacing.margin_ms;
+
+            std::this_thread::sleep_until(r->next_deadline - std::chrono::duration_cast<frame_clock_t::duration>(ms_t(budget_ms)));
+        }
+
+        this->latch_input();
+    }
+
+    void instance_t::latch_input()
+    {
+        this->m_renderer->latch   = frame_clock_t::now();
+        this->m_renderer->latched = true;
+    }
+
+    void instance_t::set_frame_pacing(frame_pacing_t const& pacing)
+    {
+        this->m_renderer->pacing        = pacing;
+        this->m_renderer->next_deadline = {};
+    }
+
+    auto instance_t::last_frame_latency() const -> frame_latency_t
+    {
+        return this->m_renderer->last_latency;
+    }
+
     auto instance_t::on_resize() -> orb::result<void>
     {
-        return this->m_renderer->create_surfaces();
+        return this->m_renderer->viewports.front()->create_surfaces();
+    }
+
+    auto instance_t::on_resize(ui32 viewport, ui32 width, ui32 height) -> orb::result<void>
+    {
+        if (viewport >= this->m_renderer->viewports.size())
+        {
+            return orb::error_t { "Invalid viewport {}", viewport };
+        }
+
+        auto& vp   = this->m_renderer->viewports[viewport];
+        vp->extent = { .width = width, .height = height };
+
+        // Only relaid out on the next update, and only where the size reaches
+        vp->layout.set_size(static_cast<f32>(width), static_cast<f32>(height));
+
+        return vp->create_surfaces();
+    }
+
+    auto instance_t::create_viewport(viewport_create_info_t const& info) -> orb::result<ui32>
+    {
+        return this->m_renderer->create_viewport(info.extent_width, info.extent_height);
+    }
+
+    auto instance_t::viewport_count() const -> ui32
+    {
+        return static_cast<ui32>(this->m_renderer->viewports.size());
+    }
+
+    auto instance_t::create_plot(plot_create_info_t&& info) -> orb::result<weak<plot_t>>
+    {
+        auto& r = this->m_renderer;
+
+        if (info.viewport >= r->viewports.size())
+        {
+            return orb::error_t { "Invalid plot viewport {}", info.viewport };
+        }
+
+        const ui32 viewport = info.viewport;
+        auto       plot_res = plot_t::create(std::move(info));
+
+        if (!plot_res)
+        {
+            return plot_res.error();
+        }
+
+        // The band index pattern is shared by every plot series
+        if (r->band_indices.handle() == VK_NULL_HANDLE)
+        {
+            std::vector<ui16> indices;
+            plot_t::band_indices(indices);
+
+            auto index_res = r->create_buffer(sizeof(ui16) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+
+            if (!index_res)
+            {
+                return index_res.error();
+            }
+
+            r->band_indices = std::move(index_res.unwrap());
+
+            if (auto res = r->upload_now(r->band_indices.handle(), indices.data(), sizeof(ui16) * indices.size()); !res)
+            {
+                return res.error();
+            }
+        }
+
+        auto plot = make_box<plot_t>(std::move(plot_res.unwrap()));
+
+        // Vertices are streamed column by column, the initial content is never drawn
+        auto vertex_res = r->create_buffer(sizeof(vertex_t) * plot->vertex_count(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+        if (!vertex_res)
+        {
+            return vertex_res.error();
+        }
+
+        r->plots.push_back({
+            .plot     = std::move(plot),
+            .viewport = viewport,
+            .vertices = std::move(vertex_res.unwrap()),
+        });
+
+        // Captured frames must declare the new buffer before drawing from it
+        r->capture_resources_pending = r->capture.has_value();
+
+        return weak<plot_t> { r->plots.back().plot.getmut() };
     }
 
     instance_t::instance_t(orb::box<gui_renderer_t> renderer)
@@ -441,13 +2053,145 @@ namespace orb::gui
     {
     }
 
-    auto instance_t::rendered_image() const -> VkImage
+    auto instance_t::create_draw_list(draw_list_create_info_t const& info) -> orb::result<weak<draw_list_t>>
+    {
+        auto& r = this->m_renderer;
+
+        if (info.viewport >= r->viewports.size())
+        {
+            return orb::error_t { "Invalid draw list viewport {}", info.viewport };
+        }
+
+        if (r->capture)
+        {
+            return orb::error_t { "Draw lists cannot be captured, end the capture first" };
+        }
+
+        r->draw_lists.push_back({
+            .list     = make_box<draw_list_t>(info.layer),
+            .viewport = info.viewport,
+        });
+
+        return weak<draw_list_t> { r->draw_lists.back().list.getmut() };
+    }
+
+    static auto check_indirect_features(gui_renderer_t const& r) -> orb::result<void>
+    {
+        VkPhysicalDeviceVulkan12Features vulkan12 {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        };
+
+        VkPhysicalDeviceFeatures2 features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &vulkan12,
+        };
+
+        vkGetPhysicalDeviceFeatures2(r.gpu, &features);
+
+        if (!features.features.multiDrawIndirect || !features.features.drawIndirectFirstInstance)
+        {
+            return orb::error_t { "Instance sets need the multiDrawIndirect and drawIndirectFirstInstance features, the GPU lacks them" };
+        }
+
+        // Supported is not enabled, the device was created by the application
+        if (!r.multi_draw_indirect)
+        {
+            return orb::error_t { "Instance sets need the multiDrawIndirect and drawIndirectFirstInstance features enabled on the device" };
+        }
+
+        if (r.draw_indirect_count && !vulkan12.drawIndirectCount)
+        {
+            return orb::error_t { "draw_indirect_count is set but the GPU lacks the drawIndirectCount feature" };
+        }
+
+        return {};
+    }
+
+    auto instance_t::create_instance_set(instance_set_create_info_t const& info) -> orb::result<weak<instance_set_t>>
+    {
+        auto& r = this->m_renderer;
+
+        if (info.viewport >= r->viewports.size())
+        {
+            return orb::error_t { "Invalid instance set viewport {}", info.viewport };
+        }
+
+        if (r->capture)
+        {
+            return orb::error_t { "Instance sets cannot be captured, end the capture first" };
+        }
+
+        // The culling pipelines are only built once a set needs them
+        if (r->instance_sets.empty())
+        {
+            if (auto res = check_indirect_features(*r); !res)
+            {
+                return res.error();
+            }
+
+            auto culler_res = gpu_culler_t::create(r->device,
+                                                   *r->pools,
+                                                   r->render_pass->handle,
+                                                   r->fs_shader_module.handle,
+                                                   r->shader_dir,
+                                                   max_frames_in_flight,
+                                                   r->draw_indirect_count);
+
+            if (!culler_res)
+            {
+                return culler_res.error();
+            }
+
+            r->culler = std::move(culler_res.unwrap());
+        }
+
+        auto gpu_res = r->culler->create_set(info.capacity);
+
+        if (!gpu_res)
+        {
+            return gpu_res.error();
+        }
+
+        r->instance_sets.push_back({
+            .set = make_box<instance_set_t>(info),
+            .gpu = std::move(gpu_res.unwrap()),
+        });
+
+        return weak<instance_set_t> { r->instance_sets.back().set.getmut() };
+    }
+
+    auto instance_t::memory_usage() const -> memory_usage_t
+    {
+        return this->m_renderer->pools->usage();
+    }
+
+    auto instance_t::layout(ui32 viewport) -> layout_tree_t&
+    {
+        assert(viewport < this->m_renderer->viewports.size());
+        return this->m_renderer->viewports[viewport]->layout;
+    }
+
+    auto instance_t::animator() -> animator_t&
+    {
+        return m_renderer->animator;
+    }
+
+    auto instance_t::clips() -> clip_stack_t&
     {
-        return this->m_renderer->images.handles[this->m_renderer->frame];
+        return m_renderer->clips;
+    }
+
+    auto instance_t::rendered_image(ui32 viewport) const -> VkImage
+    {
+        assert(viewport < this->m_renderer->viewports.size());
+
+        auto const& vp = this->m_renderer->viewports[viewport];
+        return vp->image_handles[vp->rendered];
     }
 
-    auto instance_t::render_finished() -> vk::semaphores_view_t&
+    auto instance_t::render_finished(ui32 viewport) -> vk::semaphores_view_t&
     {
-        return this->m_renderer->finished;
+        assert(viewport < this->m_renderer->viewports.size());
+        return this->m_renderer->viewports[viewport]->finished;
     }
 } // namespace orb::gui
@@ -0,0 +1,259 @@
+#include "pipeline.hpp"
+
+#include <array>
+#include <cstddef>
+
+#include "orbgui/clip.hpp"
+#include "orbgui/vertex.hpp"
+
+namespace orb::gui
+{
+    gui_pipeline_t::~gui_pipeline_t()
+    {
+        if (m_device == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_layout, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_set_layout, nullptr);
+    }
+
+    auto gui_pipeline_t::create(VkDevice       device,
+                                VkRenderPass   render_pass,
+                                VkShaderModule vertex_shader,
+                                VkShaderModule fragment_shader) -> orb::result<box<gui_pipeline_t>>
+    {
+        auto pipeline = make_box<gui_pipeline_t>();
+
+        pipeline->m_device = device;
+
+        if (auto res = pipeline->create_layout(); !res)
+        {
+            return res.error();
+        }
+
+        if (auto res = pipeline->create_pipeline(render_pass, vertex_shader, fragment_shader); !res)
+        {
+            return res.error();
+        }
+
+        return pipeline;
+    }
+
+    auto gui_pipeline_t::create_layout() -> orb::result<void>
+    {
+        const VkDescriptorSetLayoutBinding nodes {
+            .binding         = 0,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_VERTEX_BIT,
+        };
+
+        const VkDescriptorSetLayoutCreateInfo set_layout_info {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = 1,
+            .pBindings    = &nodes,
+        };
+
+        if (auto res = vkCreateDescriptorSetLayout(m_device, &set_layout_info, nullptr, &m_set_layout); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Main descriptor set layout creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const VkPushConstantRange constants {
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .offset     = 0,
+            .size       = sizeof(gui_constants_t),
+        };
+
+        const VkPipelineLayoutCreateInfo layout_info {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = 1,
+            .pSetLayouts            = &m_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &constants,
+        };
+
+        if (auto res = vkCreatePipelineLayout(m_device, &layout_info, nullptr, &m_layout); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Main pipeline layout creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const VkDescriptorPoolSize pool_size {
+            .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+        };
+
+        const VkDescriptorPoolCreateInfo pool_info {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets       = 1,
+            .poolSizeCount = 1,
+            .pPoolSizes    = &pool_size,
+        };
+
+        if (auto res = vkCreateDescriptorPool(m_device, &pool_info, nullptr, &m_pool); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Main descriptor pool creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        const VkDescriptorSetAllocateInfo alloc_info {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = m_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &m_set_layout,
+        };
+
+        if (auto res = vkAllocateDescriptorSets(m_device, &alloc_info, &m_set); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Main descriptor set allocation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        return {};
+    }
+
+    auto gui_pipeline_t::create_pipeline(VkRenderPass   render_pass,
+                                         VkShaderModule vertex_shader,
+                                         VkShaderModule fragment_shader) -> orb::result<void>
+    {
+        const std::array<VkPipelineShaderStageCreateInfo, 2> stages = { {
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = vertex_shader,
+                .pName  = "main",
+            },
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module = fragment_shader,
+                .pName  = "main",
+            },
+        } };
+
+        // Geometry per vertex, the clip of the draw per instance
+        const std::array<VkVertexInputBindingDescription, 2> bindings = { {
+            { .binding = 0, .stride = sizeof(vertex_t), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
+            { .binding = 1, .stride = sizeof(clip_entry_t), .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE },
+        } };
+
+        const std::array<VkVertexInputAttributeDescription, 6> attributes = { {
+            { .location = 0, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(vertex_t, pos) },
+            { .location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(vertex_t, col) },
+            { .location = 2, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(clip_entry_t, rect) },
+            { .location = 3, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(clip_entry_t, bounds) },
+            { .location = 4, .binding = 1, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(clip_entry_t, radius) },
+            { .location = 5, .binding = 0, .format = VK_FORMAT_R32_UINT, .offset = offsetof(vertex_t, node) },
+        } };
+
+        const VkPipelineVertexInputStateCreateInfo vertex_input {
+            .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .vertexBindingDescriptionCount   = static_cast<ui32>(bindings.size()),
+            .pVertexBindingDescriptions      = bindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<ui32>(attributes.size()),
+            .pVertexAttributeDescriptions    = attributes.data(),
+        };
+
+        const VkPipelineInputAssemblyStateCreateInfo input_assembly {
+            .sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        };
+
+        const VkPipelineViewportStateCreateInfo viewport_state {
+            .sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .viewportCount = 1,
+            .scissorCount  = 1,
+        };
+
+        const VkPipelineRasterizationStateCreateInfo rasterizer {
+            .sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .polygonMode = VK_POLYGON_MODE_FILL,
+            .cullMode    = VK_CULL_MODE_NONE,
+            .frontFace   = VK_FRONT_FACE_CLOCKWISE,
+            .lineWidth   = 1.0f,
+        };
+
+        const VkPipelineMultisampleStateCreateInfo multisample {
+            .sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        };
+
+        // Node opacity blends over what is already drawn
+        const VkPipelineColorBlendAttachmentState blend_attachment {
+            .blendEnable         = VK_TRUE,
+            .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+            .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+            .colorBlendOp        = VK_BLEND_OP_ADD,
+            .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+            .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+            .alphaBlendOp        = VK_BLEND_OP_ADD,
+            .colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+        };
+
+        const VkPipelineColorBlendStateCreateInfo blending {
+            .sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+            .attachmentCount = 1,
+            .pAttachments    = &blend_attachment,
+        };
+
+        const std::array<VkDynamicState, 2> dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+        const VkPipelineDynamicStateCreateInfo dynamic {
+            .sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .dynamicStateCount = static_cast<ui32>(dynamic_states.size()),
+            .pDynamicStates    = dynamic_states.data(),
+        };
+
+        const VkGraphicsPipelineCreateInfo pipeline_info {
+            .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .stageCount          = static_cast<ui32>(stages.size()),
+            .pStages             = stages.data(),
+            .pVertexInputState   = &vertex_input,
+            .pInputAssemblyState = &input_assembly,
+            .pViewportState      = &viewport_state,
+            .pRasterizationState = &rasterizer,
+            .pMultisampleState   = &multisample,
+            .pColorBlendState    = &blending,
+            .pDynamicState       = &dynamic,
+            .layout              = m_layout,
+            .renderPass          = render_pass,
+            .subpass             = 0,
+        };
+
+        if (auto res = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &m_pipeline); res != VK_SUCCESS)
+        {
+            return orb::error_t { "Main pipeline creation error: {}", vk::vkres::get_repr(res) };
+        }
+
+        return {};
+    }
+
+    void gui_pipeline_t::bind_nodes(VkBuffer buffer)
+    {
+        const VkDescriptorBufferInfo buffer_info {
+            .buffer = buffer,
+            .offset = 0,
+            .range  = VK_WHOLE_SIZE,
+        };
+
+        const VkWriteDescriptorSet write {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = m_set,
+            .dstBinding      = 0,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo     = &buffer_info,
+        };
+
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+    }
+
+    void gui_pipeline_t::record_bind(VkCommandBuffer cmd, gui_constants_t const& constants)
+    {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_layout, 0, 1, &m_set, 0, nullptr);
+        vkCmdPushConstants(cmd, m_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+    }
+} // namespace orb::gui
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include "orb/vk/all.hpp"
+
+namespace orb::gui
+{
+    // Push constants of main.vs.glsl
+    struct gui_constants_t
+    {
+        ui32 node_base;  // first node of this frame's slice
+        ui32 node_count; // vertices past it fall back to the root node
+    };
+
+    // Pipeline drawing vertex_t geometry. Vertices pick their node parameters
+    // from a storage buffer, so animating a node never re-uploads vertices
+    class gui_pipeline_t
+    {
+    public:
+        gui_pipeline_t() = default;
+        ~gui_pipeline_t();
+
+        gui_pipeline_t(gui_pipeline_t const&)                    = delete;
+        gui_pipeline_t(gui_pipeline_t&&)                         = delete;
+        auto operator=(gui_pipeline_t const&) -> gui_pipeline_t& = delete;
+        auto operator=(gui_pipeline_t&&) -> gui_pipeline_t&      = delete;
+
+        static auto create(VkDevice       device,
+                           VkRenderPass   render_pass,
+                           VkShaderModule vertex_shader,
+                           VkShaderModule fragment_shader) -> orb::result<box<gui_pipeline_t>>;
+
+        // The set is not double buffered, the buffer must not be in use
+        void bind_nodes(VkBuffer buffer);
+
+        // Binds the pipeline, its set and constants, also after another
+        // pipeline disturbed them
+        void record_bind(VkCommandBuffer cmd, gui_constants_t const& constants);
+
+        [[nodiscard]] auto handle() const -> VkPipeline { return m_pipeline; }
+
+    private:
+        VkDevice              m_device     = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_set_layout = VK_NULL_HANDLE;
+        VkPipelineLayout      m_layout     = VK_NULL_HANDLE;
+        VkPipeline            m_pipeline   = VK_NULL_HANDLE;
+        VkDescriptorPool      m_pool       = VK_NULL_HANDLE;
+        VkDescriptorSet       m_set        = VK_NULL_HANDLE;
+
+        auto create_layout() -> orb::result<void>;
+        auto create_pipeline(VkRenderPass render_pass, VkShaderModule vertex_shader, VkShaderModule fragment_shader) -> orb::result<void>;
+    };
+} // namespace orb::gui
@@ -0,0 +1,350 @@
+#include "orbgui/plot.hpp"
+
+#include <algorithm>
+
+namespace orb::gui
+{
+    static constexpr auto count_pyramid_levels() -> ui32
+    {
+        ui32 levels = 0;
+
+        for (ui32 n = series_t::chunk_size; n > 1; n /= series_t::fanout)
+        {
+            ++levels;
+        }
+
+        return levels;
+    }
+
+    static constexpr ui32 pyramid_levels = count_pyramid_levels();
+
+    // Offset of each pyramid level in chunk_t::pyramid, the last entry being
+    // the total node count. Level 0 is the samples themselves
+    static constexpr auto pyramid_offsets = [] {
+        std::array<ui32, pyramid_levels + 2> offsets {};
+        ui32                                 nodes = series_t::chunk_size;
+
+        for (ui32 level = 1; level <= pyramid_levels; ++level)
+        {
+            nodes /= series_t::fanout;
+            offsets[level + 1] = offsets[level] + nodes;
+        }
+
+        return offsets;
+    }();
+
+    static_assert([] {
+        ui32 n = 1;
+        for (ui32 level = 0; level < pyramid_levels; ++level) n *= series_t::fanout;
+        return n == series_t::chunk_size;
+    }(), "chunk_size must be a power of fanout");
+
+    void series_t::chunk_t::reset()
+    {
+        this->samples.resize(chunk_size);
+        this->pyramid.assign(pyramid_offsets.back(), min_max_t {});
+    }
+
+    void series_t::chunk_t::push(ui32 index, f32 value)
+    {
+        this->samples[index] = value;
+
+        for (ui32 level = 1; level <= pyramid_levels; ++level)
+        {
+            index /= fanout;
+            this->pyramid[pyramid_offsets[level] + index].add(value);
+        }
+    }
+
+    auto series_t::chunk_t::query(ui32 lo, ui32 hi) const -> min_max_t
+    {
+        auto node = [&](ui32 level, ui32 i) -> min_max_t {
+            if (level == 0) return { this->samples[i], this->samples[i] };
+            return this->pyramid[pyramid_offsets[level] + i];
+        };
+
+        min_max_t result;
+
+        // Reduce the unaligned edges at each level, then climb with what is left
+        for (ui32 level = 0; lo < hi; ++level)
+        {
+            if (level == pyramid_levels)
+            {
+                result.add(node(level, lo));
+                break;
+            }
+
+            while (lo < hi && lo % fanout != 0)
+            {
+                result.add(node(level, lo++));
+            }
+
+            while (lo < hi && hi % fanout != 0)
+            {
+                result.add(node(level, --hi));
+            }
+
+            lo /= fanout;
+            hi /= fanout;
+        }
+
+        return result;
+    }
+
+    series_t::series_t(ui64 capacity)
+        : m_chunks((capacity + chunk_size - 1) / chunk_size + 1)
+    {
+    }
+
+    auto series_t::chunk(ui64 chunk_index) -> chunk_t&
+    {
+        return m_chunks[chunk_index % m_chunks.size()];
+    }
+
+    auto series_t::chunk(ui64 chunk_index) const -> chunk_t const&
+    {
+        return m_chunks[chunk_index % m_chunks.size()];
+    }
+
+    void series_t::append(std::span<const f32> samples)
+    {
+        for (const f32 value : samples)
+        {
+            const ui64 chunk_index = m_end / chunk_size;
+            const auto index       = static_cast<ui32>(m_end % chunk_size);
+
+            if (index == 0)
+            {
+                // Starting a new chunk recycles the oldest one once the ring is full
+                this->chunk(chunk_index).reset();
+
+                if (chunk_index >= m_chunks.size())
+                {
+                    m_begin = (chunk_index - m_chunks.size() + 1) * chunk_size;
+                }
+            }
+
+            this->chunk(chunk_index).push(index, value);
+            ++m_end;
+        }
+    }
+
+    auto series_t::range(ui64 first, ui64 last) const -> min_max_t
+    {
+        first = std::max(first, m_begin);
+        last  = std::min(last, m_end);
+
+        min_max_t result;
+
+        while (first < last)
+        {
+            const ui64 chunk_index = first / chunk_size;
+            const ui64 chunk_begin = chunk_index * chunk_size;
+            const ui64 hi          = std::min(last, chunk_begin + chunk_size);
+
+            result.add(this->chunk(chunk_index)
+                           .query(static_cast<ui32>(first - chunk_begin),
+                                  static_cast<ui32>(hi - chunk_begin)));
+
+            first = hi;
+        }
+
+        return result;
+    }
+
+    auto series_t::at(ui64 index) const -> f32
+    {
+        return this->chunk(index / chunk_size).samples[index % chunk_size];
+    }
+
+    auto plot_t::create(plot_create_info_t&& info) -> orb::result<plot_t>
+    {
+        if (info.width == 0 || info.width > max_plot_columns)
+        {
+            return orb::error_t { "Plot width must be in [1, {}], got {}", max_plot_columns, info.width };
+        }
+
+        if (info.colors.empty())
+        {
+            return orb::error_t { "Plot requires at least one series" };
+        }
+
+        if (info.capacity == 0)
+        {
+            return orb::error_t { "Plot capacity must not be zero" };
+        }
+
+        if (!(info.y_min < info.y_max))
+        {
+            return orb::error_t { "Invalid plot y range [{}, {}]", info.y_min, info.y_max };
+        }
+
+        return plot_t { std::move(info) };
+    }
+
+    plot_t::plot_t(plot_create_info_t&& info)
+        : m_info(std::move(info))
+    {
+        m_samples_per_column = m_info.samples_per_column != 0
+                                 ? m_info.samples_per_column
+                                 : std::max<ui64>(1, (m_info.capacity + m_info.width - 1) / m_info.width);
+
+        const auto series_count = m_info.colors.size();
+
+        m_series.reserve(series_count);
+        for (size_t i = 0; i < series_count; ++i)
+        {
+            m_series.emplace_back(m_info.capacity);
+        }
+
+        m_uploaded_end.resize(series_count, 0);
+        m_vertices.resize(series_count * m_info.width * 2);
+    }
+
+    void plot_t::append(ui32 series, std::span<const f32> samples)
+    {
+        m_series[series].append(samples);
+    }
+
+    void plot_t::set_y_range(f32 y_min, f32 y_max)
+    {
+        m_info.y_min = y_min;
+        m_info.y_max = y_max;
+        m_full_dirty = true;
+    }
+
+    void plot_t::set_node(ui32 node)
+    {
+        m_info.node  = node;
+        m_full_dirty = true;
+    }
+
+    void plot_t::update(f32 viewport_width, f32 viewport_height)
+    {
+        if (viewport_width != m_viewport[0] || viewport_height != m_viewport[1])
+        {
+            m_viewport   = { viewport_width, viewport_height };
+            m_full_dirty = true;
+        }
+
+        m_uploads.clear();
+        m_draws.clear();
+
+        const ui64 columns = m_info.width;
+        const ui64 spp     = m_samples_per_column;
+
+        for (ui32 s = 0; s < this->series_count(); ++s)
+        {
+            auto const& series = m_series[s];
+
+            if (series.end_index() == 0)
+            {
+                continue;
+            }
+
+            // Columns still visible: the last `columns` ones, minus the evicted ones
+            const ui64 last_column  = (series.end_index() - 1) / spp;
+            const ui64 oldest       = last_column + 1 > columns ? last_column + 1 - columns : 0;
+            const ui64 first_column = std::max(series.begin_index() / spp, oldest);
+
+            if (m_full_dirty || m_uploaded_end[s] != series.end_index())
+            {
+                const ui64 dirty_column = m_full_dirty
+                                            ? first_column
+                                            : std::max(first_column, m_uploaded_end[s] / spp);
+
+                for (ui64 column = dirty_column; column <= last_column; ++column)
+                {
+                    this->write_column(s, column);
+                }
+
+                this->push_slot_ranges(s, dirty_column, last_column, true);
+                m_uploaded_end[s] = series.end_index();
+            }
+
+            this->push_slot_ranges(s, first_column, last_column, false);
+        }
+
+        m_full_dirty = false;
+    }
+
+    void plot_t::write_column(ui32 series, ui64 column)
+    {
+        const ui64 first = column * m_samples_per_column;
+
+        // Including the previous sample keeps adjacent columns connected
+        const auto mm = m_series[series].range(first > 0 ? first - 1 : 0, first + m_samples_per_column);
+
+        const ui32  slot  = column % m_info.width;
+        auto const& color = m_info.colors[series];
+        const f32   scale = m_info.height / (m_info.y_max - m_info.y_min);
+
+        auto to_px = [&](f32 value) {
+            return std::clamp(m_info.y + (m_info.y_max - value) * scale, m_info.y, m_info.y + m_info.height);
+        };
+
+        // Expand by half a pixel so flat segments still cover one pixel
+        const f32 x      = (m_info.x + static_cast<f32>(slot) + 0.5f) / m_viewport[0] * 2.0f - 1.0f;
+        const f32 top    = (to_px(mm.max) - 0.5f) / m_viewport[1] * 2.0f - 1.0f;
+        const f32 bottom = (to_px(mm.min) + 0.5f) / m_viewport[1] * 2.0f - 1.0f;
+
+        const size_t v    = (static_cast<size_t>(series) * m_info.width + slot) * 2;
+        m_vertices[v]     = { { x, top }, color, m_info.node };
+        m_vertices[v + 1] = { { x, bottom }, color, m_info.node };
+    }
+
+    void plot_t::push_slot_ranges(ui32 series, ui64 first_column, ui64 last_column, bool upload)
+    {
+        const ui32 columns    = m_info.width;
+        const ui32 base       = series * columns;
+        const auto first_slot = static_cast<ui32>(first_column % columns);
+        const auto last_slot  = static_cast<ui32>(last_column % columns);
+
+        // Slots are inclusive, a draw covers the bands between consecutive slots
+        auto push = [&](ui32 lo, ui32 hi) {
+            if (upload)
+            {
+                m_uploads.push_back({
+                    .first_vertex = (base + lo) * 2,
+                    .vertex_count = (hi - lo + 1) * 2,
+                });
+            }
+            else if (hi > lo)
+            {
+                m_draws.push_back({
+                    .first_index   = lo * 6,
+                    .index_count   = (hi - lo) * 6,
+                    .vertex_offset = static_cast<i32>(base * 2),
+                    .clip          = m_info.clip,
+                });
+            }
+        };
+
+        if (first_slot <= last_slot)
+        {
+            push(first_slot, last_slot);
+        }
+        else
+        {
+            push(first_slot, columns - 1);
+            push(0, last_slot);
+        }
+    }
+
+    void plot_t::band_indices(std::vector<ui16>& indices)
+    {
+        indices.clear();
+        indices.reserve(static_cast<size_t>(max_plot_columns - 1) * 6);
+
+        for (ui32 band = 0; band + 1 < max_plot_columns; ++band)
+        {
+            const auto top    = static_cast<ui16>(band * 2);
+            const auto bottom = static_cast<ui16>(band * 2 + 1);
+
+            const auto next_top    = static_cast<ui16>(top + 2);
+            const auto next_bottom = static_cast<ui16>(bottom + 2);
+
+            indices.insert(indices.end(), { top, next_top, next_bottom, next_bottom, bottom, top });
+        }
+    }
+} // namespace orb::gui
@@ -0,0 +1,1039 @@
+#include "orbgui/remote.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <new>
+#include <unordered_map>
+
+#include "orbgui/plot.hpp"
+#include "orbgui/vertex.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace orb::gui
+{
+    static constexpr ui32 ring_magic   = 0x4752424f; // "ORBG"
+    static constexpr ui32 remote_magic = 0x4d524247; // "GBRM"
+    static constexpr ui32 ring_wrap    = 0xffffffff;
+
+    // Zero runs shorter than this stay in the literal they interrupt
+    static constexpr size_t min_zero_run = 8;
+
+    static constexpr auto align_message(size_t size) -> size_t
+    {
+        return (size + 7) & ~static_cast<size_t>(7);
+    }
+
+    struct ring_header_t
+    {
+        ui32 magic;
+        ui32 reserved;
+        ui64 capacity;
+
+        // Monotonic byte positions, each one written by a single side
+        alignas(64) std::atomic<ui64> head; // producer
+        alignas(64) std::atomic<ui64> tail; // consumer
+    };
+
+    static_assert(std::atomic<ui64>::is_always_lock_free, "shm_ring_t requires lock-free 64 bits atomics");
+
+    static constexpr size_t ring_data_offset = (sizeof(ring_header_t) + 63) & ~static_cast<size_t>(63);
+
+    struct ring_record_t
+    {
+        ui32 size; // ring_wrap: skip to the start of the ring
+        ui32 reserved;
+    };
+
+    struct shm_ring_t::mapping_t
+    {
+        std::string    name;
+        ring_header_t* header = nullptr;
+        std::byte*     data   = nullptr;
+        size_t         size   = 0;
+        bool           owner  = false;
+
+#ifdef _WIN32
+        HANDLE mapping = nullptr;
+#endif
+
+        mapping_t() = default;
+
+        mapping_t(mapping_t const&)                    = delete;
+        mapping_t(mapping_t&&)                         = delete;
+        auto operator=(mapping_t const&) -> mapping_t& = delete;
+        auto operator=(mapping_t&&) -> mapping_t&      = delete;
+
+        ~mapping_t()
+        {
+#ifdef _WIN32
+            if (this->header != nullptr) UnmapViewOfFile(this->header);
+            if (this->mapping != nullptr) CloseHandle(this->mapping);
+#else
+            if (this->header != nullptr) munmap(this->header, this->size);
+            if (this->owner) shm_unlink(this->name.c_str());
+#endif
+        }
+
+        auto map(std::string const& channel, size_t create_size) -> orb::result<void>
+        {
+            this->owner = create_size != 0;
+
+#ifdef _WIN32
+            this->name = "Local\\orbgui-" + channel;
+            const std::wstring wname(this->name.begin(), this->name.end());
+
+            if (this->owner)
+            {
+                this->size    = create_size;
+                this->mapping = CreateFileMappingW(INVALID_HANDLE_VALUE,
+                                                   nullptr,
+                                                   PAGE_READWRITE,
+                                                   static_cast<DWORD>(create_size >> 32),
+                                                   static_cast<DWORD>(create_size),
+                                                   wname.c_str());
+            }
+            else
+            {
+                this->mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, wname.c_str());
+            }
+
+            if (this->mapping == nullptr)
+            {
+                return orb::error_t { "Could not open shared memory {}", this->name };
+            }
+
+            void* view = MapViewOfFile(this->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+
+            if (view != nullptr && !this->owner)
+            {
+                MEMORY_BASIC_INFORMATION info;
+                VirtualQuery(view, &info, sizeof(info));
+                this->size = info.RegionSize;
+            }
+#else
+            this->name = "/orbgui-" + channel;
+
+            // Reclaim a segment left behind by a producer that crashed
+            if (this->owner)
+            {
+                shm_unlink(this->name.c_str());
+            }
+
+            const int fd = this->owner ? shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)
+                                       : shm_open(this->name.c_str(), O_RDWR, 0);
+
+            if (fd < 0)
+            {
+                this->owner = false;
+                return orb::error_t { "Could not open shared memory {}", this->name };
+            }
+
+            if (this->owner && ftruncate(fd, static_cast<off_t>(create_size)) != 0)
+            {
+                ::close(fd);
+                return orb::error_t { "Could not size shared memory {} to {} bytes", this->name, create_size };
+            }
+
+            struct stat st = {};
+            fstat(fd, &st);
+            this->size = static_cast<size_t>(st.st_size);
+
+            void* view = this->size > ring_data_offset
+                           ? mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                           : MAP_FAILED;
+            ::close(fd);
+
+            if (view == MAP_FAILED)
+            {
+                view = nullptr;
+            }
+#endif
+
+            if (view == nullptr)
+            {
+                return orb::error_t { "Could not map shared memory {}", this->name };
+            }
+
+            this->header = static_cast<ring_header_t*>(view);
+            this->data   = static_cast<std::byte*>(view) + ring_data_offset;
+
+            return {};
+        }
+    };
+
+    shm_ring_t::~shm_ring_t() = default;
+
+    shm_ring_t::shm_ring_t(box<mapping_t> mapping)
+        : m_mapping(std::move(mapping))
+    {
+    }
+
+    auto shm_ring_t::create(std::string const& name, ui64 capacity) -> orb::result<shm_ring_t>
+    {
+        capacity = align_message(std::max<ui64>(capacity, 4096));
+
+        auto mapping = make_box<mapping_t>();
+
+        if (auto res = mapping->map(name, ring_data_offset + capacity); !res)
+        {
+            return res.error();
+        }
+
+        // The memory comes zeroed, publishing the magic last marks the ring ready
+        auto* header = new (mapping->header) ring_header_t {};
+
+        header->capacity = capacity;
+        std::atomic_ref(header->magic).store(ring_magic, std::memory_order_release);
+
+        return shm_ring_t { std::move(mapping) };
+    }
+
+    auto shm_ring_t::open(std::string const& name) -> orb::result<shm_ring_t>
+    {
+        auto mapping = make_box<mapping_t>();
+
+        if (auto res = mapping->map(name, 0); !res)
+        {
+            return res.error();
+        }
+
+        auto const& header = *mapping->header;
+
+        if (std::atomic_ref(const_cast<ui32&>(header.magic)).load(std::memory_order_acquire) != ring_magic)
+        {
+            return orb::error_t { "Shared memory {} is not a ready ring", mapping->name };
+        }
+
+        if (ring_data_offset + header.capacity > mapping->size)
+        {
+            return orb::error_t { "Shared memory {} is smaller than its ring", mapping->name };
+        }
+
+        return shm_ring_t { std::move(mapping) };
+    }
+
+    auto shm_ring_t::capacity() const -> ui64
+    {
+        return m_mapping->header->capacity;
+    }
+
+    auto shm_ring_t::push(std::span<const std::byte> message) -> bool
+    {
+        auto&      header   = *m_mapping->header;
+        const ui64 capacity = header.capacity;
+        const ui64 head     = header.head.load(std::memory_order_relaxed);
+        const ui64 tail     = header.tail.load(std::memory_order_acquire);
+        const ui64 record   = sizeof(ring_record_t) + align_message(message.size());
+        const ui64 offset   = head % capacity;
+
+        // Bigger records may never fit after a wrap, even with the ring empty
+        if (record > capacity / 2)
+        {
+            return false;
+        }
+
+        // Records never straddle the end of the ring
+        const ui64 skip = capacity - offset < record ? capacity - offset : 0;
+
+        if (capacity - (head - tail) < skip + record)
+        {
+            return false;
+        }
+
+        if (skip != 0)
+        {
+            const ring_record_t wrap { .size = ring_wrap, .reserved = 0 };
+            std::memcpy(m_mapping->data + offset, &wrap, sizeof(wrap));
+        }
+
+        const ring_record_t header_record {
+            .size     = static_cast<ui32>(message.size()),
+            .reserved = 0,
+        };
+
+        std::byte* dst = m_mapping->data + (head + skip) % capacity;
+        std::memcpy(dst, &header_record, sizeof(header_record));
+        std::memcpy(dst + sizeof(header_record), message.data(), message.size());
+
+        header.head.store(head + skip + record, std::memory_order_release);
+
+        return true;
+    }
+
+    auto shm_ring_t::pop(std::vector<std::byte>& message) -> orb::result<bool>
+    {
+        auto&      header   = *m_mapping->header;
+        const ui64 capacity = header.capacity;
+        const ui64 head     = header.head.load(std::memory_order_acquire);
+        ui64       tail     = header.tail.load(std::memory_order_relaxed);
+
+        if (tail == head)
+        {
+            return false;
+        }
+
+        // Both positions and the records live in memory the producer writes,
+        // a record must lie between the tail and the head, within the ring
+        if (head - tail > capacity || tail % sizeof(ring_record_t) != 0)
+        {
+            return orb::error_t { "Corrupt ring positions, head {} tail {}", head, tail };
+        }
+
+        ring_record_t record;
+        std::memcpy(&record, m_mapping->data + tail % capacity, sizeof(record));
+
+        if (record.size == ring_wrap)
+        {
+            tail += capacity - tail % capacity;
+
+            if (head - tail > capacity || head == tail)
+            {
+                return orb::error_t { "Ring wraps past its head {}", head };
+            }
+
+            std::memcpy(&record, m_mapping->data + tail % capacity, sizeof(record));
+        }
+
+        const ui64 used = sizeof(record) + align_message(record.size);
+
+        if (used > head - tail || used > capacity - tail % capacity)
+        {
+            return orb::error_t { "Ring record of {} bytes overruns the ring", record.size };
+        }
+
+        std::byte const* src = m_mapping->data + tail % capacity + sizeof(record);
+        message.assign(src, src + record.size);
+
+        header.tail.store(tail + used, std::memory_order_release);
+
+        return true;
+    }
+
+    static void write_varint(std::vector<std::byte>& out, ui64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<std::byte>(value | 0x80));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<std::byte>(value));
+    }
+
+    static auto read_varint(std::span<const std::byte>& in, ui64& value) -> bool
+    {
+        value = 0;
+
+        for (ui32 shift = 0; shift < 64 && !in.empty(); shift += 7)
+        {
+            const auto byte = static_cast<ui8>(in.front());
+            in              = in.subspan(1);
+            value |= static_cast<ui64>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Encoded as (zero run, literal length, literal bytes) triplets of the
+    // XOR between both contents, unchanged bytes cost nothing but the runs
+    auto encode_delta(std::span<const std::byte> current,
+                      std::span<const std::byte> previous,
+                      std::vector<std::byte>&    out) -> void
+    {
+        const size_t size = current.size();
+
+        auto diff = [&](size_t i) { return current[i] ^ previous[i]; };
+
+        size_t i = 0;
+
+        while (i < size)
+        {
+            const size_t run_begin = i;
+
+            while (i < size && diff(i) == std::byte { 0 })
+            {
+                ++i;
+            }
+
+            // Extend the literal up to the next zero run worth breaking it for
+            const size_t literal_begin = i;
+            size_t       literal_end   = i;
+            size_t       zeros         = 0;
+
+            while (i < size && zeros < min_zero_run)
+            {
+                zeros = diff(i) == std::byte { 0 } ? zeros + 1 : 0;
+                ++i;
+
+                if (zeros == 0)
+                {
+                    literal_end = i;
+                }
+            }
+
+            i = literal_end;
+
+            if (literal_end == literal_begin)
+            {
+                break;
+            }
+
+            write_varint(out, literal_begin - run_begin);
+            write_varint(out, literal_end - literal_begin);
+
+            for (size_t j = literal_begin; j < literal_end; ++j)
+            {
+                out.push_back(diff(j));
+            }
+        }
+    }
+
+    auto apply_delta(std::span<const std::byte> encoded, std::span<std::byte> content) -> orb::result<void>
+    {
+        size_t position = 0;
+
+        while (!encoded.empty())
+        {
+            ui64 run     = 0;
+            ui64 literal = 0;
+
+            if (!read_varint(encoded, run) || !read_varint(encoded, literal) || literal > encoded.size())
+            {
+                return orb::error_t { "Truncated delta" };
+            }
+
+            // Checked one at a time, their sum may wrap
+            if (run > content.size() - position || literal > content.size() - position - run)
+            {
+                return orb::error_t { "Delta overflows its {} bytes range", content.size() };
+            }
+
+            position += run;
+
+            for (ui64 j = 0; j < literal; ++j)
+            {
+                content[position++] ^= encoded[j];
+            }
+
+            encoded = encoded.subspan(literal);
+        }
+
+        return {};
+    }
+
+    static void append_bytes(std::vector<std::byte>& out, void const* data, size_t size)
+    {
+        auto const* bytes = static_cast<std::byte const*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    // Appends an op whose payload is `payload` followed by `extra`
+    template <typename T>
+    static void append_op(std::vector<std::byte>& out, remote_op type, T const& payload, std::span<const std::byte> extra = {})
+    {
+        const size_t size   = sizeof(T) + extra.size();
+        const size_t padded = align_message(size);
+
+        const remote_op_header_t header {
+            .type = type,
+            .size = static_cast<ui32>(padded),
+        };
+
+        append_bytes(out, &header, sizeof(header));
+        append_bytes(out, &payload, sizeof(T));
+        out.insert(out.end(), extra.begin(), extra.end());
+        out.resize(out.size() + padded - size, std::byte { 0 });
+    }
+
+    // Content of a buffer right after its buffer_create. The band indices are
+    // known to both sides, so they never cross the channel
+    static void initial_content(ui32 buffer, ui64 size, std::vector<std::byte>& out)
+    {
+        out.assign(size, std::byte { 0 });
+
+        if (buffer == capture_band_indices)
+        {
+            std::vector<ui16> indices;
+            plot_t::band_indices(indices);
+            std::memcpy(out.data(), indices.data(), std::min<size_t>(size, indices.size() * sizeof(ui16)));
+        }
+    }
+
+    struct remote_sender_t::state_t
+    {
+        struct plot_slot_t
+        {
+            box<plot_t>            plot;
+            ui32                   viewport;
+            std::vector<std::byte> shadow; // content as the receiver knows it
+            bool                   created = false;
+        };
+
+        shm_ring_t                               ring;
+        std::vector<viewport_create_info_t>      viewports;
+        std::vector<plot_slot_t>                 plots;
+        std::vector<ui16>                        band_indices;
+        std::vector<std::vector<capture_draw_t>> last_draws;
+        std::vector<capture_draw_t>              draws;
+        std::vector<std::byte>                   message;
+        std::vector<std::byte>                   encoded;
+        std::vector<std::byte>                   initial;
+
+        ui64 frame             = 0;
+        ui64 bytes_sent        = 0;
+        ui64 frames_dropped    = 0;
+        bool keyframe          = true;
+        bool band_indices_sent = false;
+
+        explicit state_t(shm_ring_t&& channel)
+            : ring(std::move(channel))
+        {
+        }
+
+        // Sends `current` as the XOR delta against `shadow`, then updates it
+        void delta(ui32 buffer, ui64 offset, std::span<const std::byte> current, std::span<std::byte> shadow)
+        {
+            this->encoded.clear();
+            encode_delta(current, shadow, this->encoded);
+            std::memcpy(shadow.data(), current.data(), current.size());
+
+            if (this->encoded.empty())
+            {
+                return;
+            }
+
+            const remote_delta_t payload {
+                .buffer       = buffer,
+                .encoded_size = static_cast<ui32>(this->encoded.size()),
+                .offset       = offset,
+                .size         = current.size(),
+            };
+
+            append_op(this->message, remote_op::buffer_delta, payload, this->encoded);
+        }
+
+        void create(ui32 buffer, capture_buffer_usage usage, std::span<const std::byte> content)
+        {
+            const capture_buffer_create_t payload {
+                .buffer = buffer,
+                .usage  = usage,
+                .size   = content.size(),
+            };
+
+            append_op(this->message, remote_op::buffer_create, payload);
+
+            initial_content(buffer, content.size(), this->initial);
+            this->delta(buffer, 0, content, this->initial);
+        }
+
+        void record_passes()
+        {
+            this->last_draws.resize(this->viewports.size());
+
+            for (ui32 v = 0; v < this->viewports.size(); ++v)
+            {
+                this->draws.clear();
+
+                for (ui32 i = 0; i < this->plots.size(); ++i)
+                {
+                    auto const& slot = this->plots[i];
+
+                    if (slot.viewport != v)
+                    {
+                        continue;
+                    }
+
+                    for (auto const& draw : slot.plot->draws())
+                    {
+                        this->draws.push_back({
+                            .vertex_buffer = capture_first_plot + i,
+                            .index_buffer  = capture_band_indices,
+                            .first_index   = draw.first_index,
+                            .index_count   = draw.index_count,
+                            .vertex_offset = draw.vertex_offset,
+                            .clip          = clip_stack_t::no_clip,
+                        });
+                    }
+                }
+
+                auto& last = this->last_draws[v];
+
+                const bool same = !this->keyframe
+                               && last.size() == this->draws.size()
+                               && std::memcmp(last.data(), this->draws.data(), this->draws.size() * sizeof(capture_draw_t)) == 0;
+
+                if (same)
+                {
+                    append_op(this->message, remote_op::repeat_pass, v);
+                    continue;
+                }
+
+                const auto& extent = this->viewports[v];
+
+                const capture_viewport_t payload {
+                    .viewport       = v,
+                    .width          = extent.extent_width,
+                    .height         = extent.extent_height,
+                    .scissor_x      = 0,
+                    .scissor_y      = 0,
+                    .scissor_width  = extent.extent_width,
+                    .scissor_height = extent.extent_height,
+                    .reserved       = 0,
+                };
+
+                append_op(this->message, remote_op::pass, payload, std::as_bytes(std::span { this->draws }));
+                last = this->draws;
+            }
+        }
+    };
+
+    static_assert(sizeof(capture_draw_t) % 8 == 0, "pass payloads rely on unpadded draw arrays");
+
+    remote_sender_t::~remote_sender_t() = default;
+
+    remote_sender_t::remote_sender_t(box<state_t> state)
+        : m_state(std::move(state))
+    {
+    }
+
+    auto remote_sender_t::create(remote_sender_create_info_t&& info) -> orb::result<remote_sender_t>
+    {
+        if (info.viewports.empty())
+        {
+            return orb::error_t { "Remote sender requires at least one viewport" };
+        }
+
+        auto ring = shm_ring_t::create(info.channel, info.ring_size);
+
+        if (!ring)
+        {
+            return ring.error();
+        }
+
+        auto state = make_box<state_t>(std::move(ring.unwrap()));
+
+        state->viewports = std::move(info.viewports);
+        plot_t::band_indices(state->band_indices);
+
+        return remote_sender_t { std::move(state) };
+    }
+
+    auto remote_sender_t::create_plot(plot_create_info_t&& info) -> orb::result<weak<plot_t>>
+    {
+        auto& s = *m_state;
+
+        if (info.viewport >= s.viewports.size())
+        {
+            return orb::error_t { "Plot targets unknown viewport {}", info.viewport };
+        }
+
+        if (info.clip != clip_stack_t::no_clip)
+        {
+            return orb::error_t { "Remote frames carry no clips, plot clip {} is unsupported", info.clip };
+        }
+
+        const ui32 viewport = info.viewport;
+        auto       plot     = plot_t::create(std::move(info));
+
+        if (!plot)
+        {
+            return plot.error();
+        }
+
+        s.plots.push_back({
+            .plot     = make_box<plot_t>(std::move(plot.unwrap())),
+            .viewport = viewport,
+            .shadow   = {},
+        });
+
+        return weak<plot_t> { s.plots.back().plot.getmut() };
+    }
+
+    auto remote_sender_t::publish() -> orb::result<bool>
+    {
+        auto& s = *m_state;
+
+        s.message.clear();
+
+        const remote_frame_header_t header {
+            .magic = remote_magic,
+            .flags = s.keyframe ? remote_keyframe : 0,
+            .frame = s.frame++,
+        };
+
+        append_bytes(s.message, &header, sizeof(header));
+
+        // Band indices only need declaring, with keyframes and the first plot
+        if ((s.keyframe || !s.band_indices_sent) && !s.plots.empty())
+        {
+            s.create(capture_band_indices, capture_buffer_usage::index, std::as_bytes(std::span { s.band_indices }));
+            s.band_indices_sent = true;
+        }
+
+        for (ui32 i = 0; i < s.plots.size(); ++i)
+        {
+            auto&       slot   = s.plots[i];
+            auto const& extent = s.viewports[slot.viewport];
+
+            slot.plot->update(static_cast<f32>(extent.extent_width), static_cast<f32>(extent.extent_height));
+
+            const auto vertices = std::as_bytes(slot.plot->vertices());
+            const ui32 buffer   = capture_first_plot + i;
+
+            if (s.keyframe || !slot.created)
+            {
+                s.create(buffer, capture_buffer_usage::vertex, vertices);
+                slot.shadow.assign(vertices.begin(), vertices.end());
+                slot.created = true;
+                continue;
+            }
+
+            for (auto const& upload : slot.plot->uploads())
+            {
+                const size_t offset = static_cast<size_t>(upload.first_vertex) * sizeof(vertex_t);
+                const size_t size   = static_cast<size_t>(upload.vertex_count) * sizeof(vertex_t);
+
+                s.delta(buffer, offset, vertices.subspan(offset, size), std::span { slot.shadow }.subspan(offset, size));
+            }
+        }
+
+        // A clip set after creation would be dropped by the receiver
+        for (auto const& slot : s.plots)
+        {
+            for (auto const& draw : slot.plot->draws())
+            {
+                if (draw.clip != clip_stack_t::no_clip)
+                {
+                    return orb::error_t { "Remote frames carry no clips, plot clip {} is unsupported", draw.clip };
+                }
+            }
+        }
+
+        s.record_passes();
+
+        // push() never accepts it, dropping it would resend a keyframe forever
+        if (sizeof(ring_record_t) + align_message(s.message.size()) > s.ring.capacity() / 2)
+        {
+            return orb::error_t { "Remote frame of {} bytes exceeds half the {} bytes ring", s.message.size(), s.ring.capacity() };
+        }
+
+        // The receiver never sees a dropped frame, so resynchronise from scratch
+        if (!s.ring.push(s.message))
+        {
+            s.frames_dropped++;
+            s.keyframe = true;
+            return false;
+        }
+
+        s.bytes_sent += s.message.size();
+        s.keyframe = false;
+
+        return true;
+    }
+
+    auto remote_sender_t::bytes_sent() const -> ui64
+    {
+        return m_state->bytes_sent;
+    }
+
+    auto remote_sender_t::frames_dropped() const -> ui64
+    {
+        return m_state->frames_dropped;
+    }
+
+    struct remote_receiver_t::state_t
+    {
+        struct shadow_t
+        {
+            capture_buffer_usage   usage;
+            std::vector<std::byte> bytes;
+        };
+
+        struct pending_upload_t
+        {
+            ui32 buffer;
+            ui64 offset;
+            ui64 size;
+        };
+
+        shm_ring_t                           ring;
+        std::unordered_map<ui32, shadow_t>   shadows;
+        std::map<ui32, replay_pass_t>        passes;
+        std::vector<capture_buffer_create_t> creates;
+        std::vector<pending_upload_t>        uploads;
+        std::vector<std::byte>               message;
+
+        ui64 frame          = 0;
+        ui64 bytes_received = 0;
+
+        explicit state_t(shm_ring_t&& channel)
+            : ring(std::move(channel))
+        {
+        }
+
+        auto apply(std::span<const std::byte> bytes) -> orb::result<void>
+        {
+            remote_frame_header_t header;
+
+            if (bytes.size() < sizeof(header))
+            {
+                return orb::error_t { "Truncated remote frame" };
+            }
+
+            std::memcpy(&header, bytes.data(), sizeof(header));
+
+            if (header.magic != remote_magic)
+            {
+                return orb::error_t { "Not a remote frame" };
+            }
+
+            this->frame = header.frame;
+
+            // A keyframe carries every buffer and pass again
+            if ((header.flags & remote_keyframe) != 0)
+            {
+                this->shadows.clear();
+                this->passes.clear();
+                this->creates.clear();
+                this->uploads.clear();
+            }
+
+            auto ops = bytes.subspan(sizeof(header));
+
+            while (!ops.empty())
+            {
+                remote_op_header_t op;
+
+                if (ops.size() < sizeof(op))
+                {
+                    return orb::error_t { "Truncated remote op in frame {}", header.frame };
+                }
+
+                std::memcpy(&op, ops.data(), sizeof(op));
+
+                if (ops.size() - sizeof(op) < op.size)
+                {
+                    return orb::error_t { "Truncated remote op in frame {}", header.frame };
+                }
+
+                const auto payload = ops.subspan(sizeof(op), op.size);
+                ops                = ops.subspan(sizeof(op) + op.size);
+
+                if (auto res = this->apply_op(op.type, payload); !res)
+                {
+                    return res;
+                }
+            }
+
+            return {};
+        }
+
+        auto apply_op(remote_op type, std::span<const std::byte> payload) -> orb::result<void>
+        {
+            switch (type)
+            {
+                case remote_op::buffer_create:
+                {
+                    capture_buffer_create_t create;
+
+                    if (payload.size() < sizeof(create))
+                    {
+                        return orb::error_t { "Truncated remote buffer create in frame {}", this->frame };
+                    }
+
+                    std::memcpy(&create, payload.data(), sizeof(create));
+
+                    if (create.usage != capture_buffer_usage::vertex && create.usage != capture_buffer_usage::index)
+                    {
+                        return orb::error_t { "Unknown remote buffer usage {} in frame {}", static_cast<ui32>(create.usage), this->frame };
+                    }
+
+                    if (create.size > remote_max_buffer_size)
+                    {
+                        return orb::error_t { "Remote buffer of {} bytes exceeds {} in frame {}", create.size, remote_max_buffer_size, this->frame };
+                    }
+
+                    auto& shadow = this->shadows[create.buffer];
+                    shadow.usage = create.usage;
+                    initial_content(create.buffer, create.size, shadow.bytes);
+
+                    std::erase_if(this->creates, [&](auto const& c) { return c.buffer == create.buffer; });
+                    std::erase_if(this->uploads, [&](auto const& u) { return u.buffer == create.buffer; });
+                    this->creates.push_back(create);
+                    this->uploads.push_back({ .buffer = create.buffer, .offset = 0, .size = create.size });
+                    return {};
+                }
+                case remote_op::buffer_delta:
+                {
+                    remote_delta_t delta;
+
+                    if (payload.size() < sizeof(delta))
+                    {
+                        return orb::error_t { "Truncated remote delta in frame {}", this->frame };
+                    }
+
+                    std::memcpy(&delta, payload.data(), sizeof(delta));
+
+                    if (delta.encoded_size > payload.size() - sizeof(delta))
+                    {
+                        return orb::error_t { "Remote delta of {} encoded bytes overruns its op in frame {}", delta.encoded_size, this->frame };
+                    }
+
+                    auto it = this->shadows.find(delta.buffer);
+
+                    if (it == this->shadows.end()
+                        || delta.offset > it->second.bytes.size()
+                        || delta.size > it->second.bytes.size() - delta.offset)
+                    {
+                        return orb::error_t { "Remote delta to unknown or too small buffer {} in frame {}", delta.buffer, this->frame };
+                    }
+
+                    auto content = std::span { it->second.bytes }.subspan(delta.offset, delta.size);
+
+                    if (auto res = apply_delta(payload.subspan(sizeof(delta), delta.encoded_size), content); !res)
+                    {
+                        return res;
+                    }
+
+                    this->uploads.push_back({ .buffer = delta.buffer, .offset = delta.offset, .size = delta.size });
+                    return {};
+                }
+                case remote_op::pass:
+                {
+                    replay_pass_t pass;
+
+                    if (payload.size() < sizeof(pass.viewport))
+                    {
+                        return orb::error_t { "Truncated remote pass in frame {}", this->frame };
+                    }
+
+                    std::memcpy(&pass.viewport, payload.data(), sizeof(pass.viewport));
+
+                    const auto draws = payload.subspan(sizeof(pass.viewport));
+                    pass.draws.resize(draws.size() / sizeof(capture_draw_t));
+                    std::memcpy(pass.draws.data(), draws.data(), pass.draws.size() * sizeof(capture_draw_t));
+
+                    this->passes[pass.viewport.viewport] = std::move(pass);
+                    return {};
+                }
+                case remote_op::repeat_pass:
+                {
+                    ui32 viewport;
+
+                    if (payload.size() < sizeof(viewport))
+                    {
+                        return orb::error_t { "Truncated remote repeat pass in frame {}", this->frame };
+                    }
+
+                    std::memcpy(&viewport, payload.data(), sizeof(viewport));
+
+                    if (!this->passes.contains(viewport))
+                    {
+                        return orb::error_t { "Remote frame {} repeats unknown viewport {}", this->frame, viewport };
+                    }
+
+                    return {};
+                }
+                default:
+                    return orb::error_t { "Unknown remote op {} in frame {}", static_cast<ui32>(type), this->frame };
+            }
+        }
+    };
+
+    remote_receiver_t::~remote_receiver_t() = default;
+
+    remote_receiver_t::remote_receiver_t(box<state_t> state)
+        : m_state(std::move(state))
+    {
+    }
+
+    auto remote_receiver_t::open(std::string const& channel) -> orb::result<remote_receiver_t>
+    {
+        auto ring = shm_ring_t::open(channel);
+
+        if (!ring)
+        {
+            return ring.error();
+        }
+
+        return remote_receiver_t { make_box<state_t>(std::move(ring.unwrap())) };
+    }
+
+    auto remote_receiver_t::poll(replay_frame_t& frame) -> orb::result<bool>
+    {
+        auto& s = *m_state;
+
+        s.creates.clear();
+        s.uploads.clear();
+
+        bool received = false;
+
+        while (true)
+        {
+            auto popped = s.ring.pop(s.message);
+
+            if (!popped)
+            {
+                return popped.error();
+            }
+
+            if (!popped.unwrap())
+            {
+                break;
+            }
+
+            if (auto res = s.apply(s.message); !res)
+            {
+                return res.error();
+            }
+
+            s.bytes_received += s.message.size();
+            received = true;
+        }
+
+        // Uploads read the shadows once every message is applied, so a range
+        // touched by several frames goes up with its latest content
+        frame.frame   = s.frame;
+        frame.creates = s.creates;
+        frame.uploads.clear();
+        frame.passes.clear();
+
+        for (auto const& upload : s.uploads)
+        {
+            frame.uploads.push_back({
+                .buffer = upload.buffer,
+                .offset = upload.offset,
+                .data   = std::span<const std::byte> { s.shadows[upload.buffer].bytes }.subspan(upload.offset, upload.size),
+            });
+        }
+
+        for (auto const& [viewport, pass] : s.passes)
+        {
+            frame.passes.push_back(pass);
+        }
+
+        return received;
+    }
+
+    auto remote_receiver_t::bytes_received() const -> ui64
+    {
+        return m_state->bytes_received;
+    }
+} // namespace orb::gui
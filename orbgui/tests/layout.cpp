@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "orbgui/layout.hpp"
+
+using namespace orb;
+using namespace orb::gui;
+
+namespace
+{
+    // Nested rows, columns and a grid, the leaves measuring `text` wide
+    struct fixture_t
+    {
+        layout_tree_t              tree;
+        std::vector<layout_node_t> nodes;
+        std::vector<layout_node_t> leaves;
+        f32                        text = 40.0f;
+        layout_node_t              label;
+
+        explicit fixture_t(f32 width, f32 height, f32 text_width)
+            : text(text_width)
+        {
+            tree.set_size(width, height);
+
+            auto add = [&](layout_node_t parent, layout_style_t const& style) {
+                const auto node = tree.add(parent, style).unwrap();
+                nodes.push_back(node);
+                return node;
+            };
+
+            auto leaf = [&](layout_node_t parent, layout_style_t const& style) {
+                const auto node = add(parent, style);
+                tree.set_measure(node, [this](layout_constraints_t const& c) {
+                    return layout_size_t { std::min(text, c.max_width), 16.0f };
+                });
+                leaves.push_back(node);
+                return node;
+            };
+
+            add(tree.root(), { .height = 30.0f });
+
+            const auto body = add(tree.root(), { .kind = layout_kind::row, .grow = 1.0f, .padding = { 4, 4, 4, 4 }, .gap = 2.0f });
+            const auto side = add(body, { .kind = layout_kind::column, .align = layout_align::start, .gap = 2.0f });
+
+            for (ui32 i = 0; i < 5; ++i)
+            {
+                const auto row = add(side, { .kind = layout_kind::row, .align = layout_align::center, .gap = 4.0f });
+                add(row, { .width = 16.0f, .height = 16.0f });
+                label = leaf(row, {});
+            }
+
+            const auto grid = add(body, { .kind = layout_kind::grid, .grow = 1.0f, .gap = 2.0f, .grid_columns = 3 });
+
+            for (ui32 i = 0; i < 10; ++i)
+            {
+                const auto cell = add(grid, { .kind = layout_kind::column, .padding = { 2, 2, 2, 2 } });
+                leaf(cell, { .shrink = 0.0f });
+            }
+        }
+    };
+
+    auto same_rects(fixture_t const& a, fixture_t const& b) -> bool
+    {
+        for (size_t i = 0; i < a.nodes.size(); ++i)
+        {
+            const auto ra = a.tree.rect(a.nodes[i]);
+            const auto rb = b.tree.rect(b.nodes[i]);
+
+            if (ra.x != rb.x || ra.y != rb.y || ra.width != rb.width || ra.height != rb.height)
+            {
+                std::printf("node %u: %g %g %g %g != %g %g %g %g\n", a.nodes[i], ra.x, ra.y, ra.width, ra.height, rb.x, rb.y, rb.width, rb.height);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    auto check(bool condition, char const* what) -> bool
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", what);
+        }
+
+        return condition;
+    }
+} // namespace
+
+// Incremental updates must land on the same rects as a layout from scratch
+auto main() -> int
+{
+    bool ok = true;
+
+    fixture_t incremental { 800.0f, 600.0f, 40.0f };
+    incremental.tree.update();
+
+    {
+        fixture_t fresh { 800.0f, 600.0f, 40.0f };
+        fresh.tree.update();
+        ok &= check(same_rects(incremental, fresh), "first update matches");
+    }
+
+    const auto clean = incremental.tree.update();
+    ok &= check(clean.laid_out == 0 && clean.measured == 0, "clean update does no work");
+
+    // Dirty leaf whose content did not change
+    incremental.tree.mark_dirty(incremental.label);
+    incremental.tree.update();
+
+    {
+        fixture_t fresh { 800.0f, 600.0f, 40.0f };
+        fresh.tree.update();
+        ok &= check(same_rects(incremental, fresh), "unchanged dirty leaf matches");
+    }
+
+    // Dirty leaves whose content grew
+    incremental.text = 90.0f;
+
+    for (const auto node : incremental.leaves)
+    {
+        incremental.tree.mark_dirty(node);
+    }
+
+    const auto grown = incremental.tree.update();
+    ok &= check(grown.laid_out < incremental.tree.node_count(), "grown leaves skip clean nodes");
+
+    {
+        fixture_t fresh { 800.0f, 600.0f, 90.0f };
+        fresh.tree.update();
+        ok &= check(same_rects(incremental, fresh), "grown leaves match");
+    }
+
+    // Resize
+    incremental.tree.set_size(640.0f, 700.0f);
+    incremental.tree.update();
+
+    {
+        fixture_t fresh { 640.0f, 700.0f, 90.0f };
+        fresh.tree.update();
+        ok &= check(same_rects(incremental, fresh), "resize matches");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#version 450
+
+// Culls the items of an instance set against the viewport and their clip,
+// then compacts the survivors. Each workgroup owns a fixed range of the
+// visible list and one indirect draw, so the item order is kept without a
+// global scan
+
+layout(local_size_x = 256) in;
+
+struct Item {
+    vec4 rect;
+    vec4 color;
+    uint clip;
+    uint reserved[3];
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Items { Item items[]; };
+layout(std430, set = 0, binding = 1) writeonly buffer Visible { uint visible[]; };
+layout(std430, set = 0, binding = 2) writeonly buffer Commands { uint commands[]; };
+layout(std430, set = 0, binding = 3) buffer Counts { uint counts[]; };
+
+// clip_entry_t is 10 floats: rect, bounds, radius, reserved
+layout(std430, set = 0, binding = 4) readonly buffer Clips { float clips[]; };
+
+layout(push_constant) uniform Constants {
+    vec2 scale;
+    vec2 offset;
+    vec2 extent;
+    uint itemCount;
+    uint clipCount;
+    uint visibleBase;
+    uint commandBase;
+    uint clipBase;
+    uint frame;
+} pc;
+
+shared uint scan[256];
+
+bool isVisible(uint index) {
+    if (index >= pc.itemCount) {
+        return false;
+    }
+
+    Item item = items[index];
+
+    vec2 a = item.rect.xy * pc.scale + pc.offset;
+    vec2 b = item.rect.zw * pc.scale + pc.offset;
+    vec4 rect = vec4(min(a, b), max(a, b));
+
+    // Unknown clips fall back to the unclipped root
+    uint clip = item.clip < pc.clipCount ? item.clip : 0u;
+    uint base = (pc.clipBase + clip) * 10u + 4u;
+
+    vec4 bounds = vec4(clips[base], clips[base + 1u], clips[base + 2u], clips[base + 3u]);
+    bounds = vec4(max(bounds.xy, vec2(0.0)), min(bounds.zw, pc.extent));
+
+    return all(lessThan(rect.xy, bounds.zw)) && all(greaterThan(rect.zw, bounds.xy));
+}
+
+void main() {
+    uint local = gl_LocalInvocationID.x;
+    uint group = gl_WorkGroupID.x;
+    uint index = gl_GlobalInvocationID.x;
+
+    bool keep = isVisible(index);
+    scan[local] = keep ? 1u : 0u;
+    barrier();
+
+    // Inclusive Hillis-Steele scan of the survivor flags
+    for (uint stride = 1u; stride < 256u; stride <<= 1u) {
+        uint value = local >= stride ? scan[local - stride] : 0u;
+        barrier();
+        scan[local] += value;
+        barrier();
+    }
+
+    uint first = pc.visibleBase + group * 256u;
+
+    if (keep) {
+        visible[first + scan[local] - 1u] = index;
+    }
+
+    if (local == 0u) {
+        uint survivors = scan[255];
+        uint command = (pc.commandBase + group) * 5u;
+
+        // VkDrawIndexedIndirectCommand drawing the quad once per survivor
+        commands[command] = 6u;
+        commands[command + 1u] = survivors;
+        commands[command + 2u] = 0u;
+        commands[command + 3u] = 0u;
+        commands[command + 4u] = first;
+
+        if (survivors > 0u) {
+            atomicMax(counts[pc.frame], group + 1u);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#version 450
+
+// Draws the survivors of the culling pass, one quad instance each. The
+// first instance of each draw points into the visible list
+
+struct Item {
+    vec4 rect;
+    vec4 color;
+    uint clip;
+    uint reserved[3];
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Items { Item items[]; };
+layout(std430, set = 0, binding = 1) readonly buffer Visible { uint visible[]; };
+layout(std430, set = 0, binding = 4) readonly buffer Clips { float clips[]; };
+
+layout(push_constant) uniform Constants {
+    vec2 scale;
+    vec2 offset;
+    vec2 extent;
+    uint itemCount;
+    uint clipCount;
+    uint visibleBase;
+    uint commandBase;
+    uint clipBase;
+    uint frame;
+} pc;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) flat out vec4 fragClipRect;
+layout(location = 2) flat out vec4 fragClipBounds;
+layout(location = 3) flat out float fragClipRadius;
+layout(location = 4) out float fragOpacity;
+
+void main() {
+    Item item = items[visible[gl_InstanceIndex]];
+
+    vec2 a = item.rect.xy * pc.scale + pc.offset;
+    vec2 b = item.rect.zw * pc.scale + pc.offset;
+
+    // Corners in the order of the quad indices
+    uint corner = gl_VertexIndex & 3u;
+    vec2 p = vec2(corner == 1u || corner == 2u ? b.x : a.x, corner >= 2u ? b.y : a.y);
+
+    gl_Position = vec4(p / pc.extent * 2.0 - 1.0, 0.0, 1.0);
+    fragColor = item.color.rgb;
+    fragOpacity = 1.0;
+
+    uint clip = (pc.clipBase + (item.clip < pc.clipCount ? item.clip : 0u)) * 10u;
+
+    fragClipRect = vec4(clips[clip], clips[clip + 1u], clips[clip + 2u], clips[clip + 3u]);
+    fragClipBounds = vec4(clips[clip + 4u], clips[clip + 5u], clips[clip + 6u], clips[clip + 7u]);
+    fragClipRadius = clips[clip + 8u];
+}
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <cmath>
 #include <span>
 #include <thread>
 
@@ -9,7 +11,12 @@
 
 #include "sample.hpp"
 
+#include <orbgui/animation.hpp>
+#include <orbgui/clip.hpp>
+#include <orbgui/draw_list.hpp>
+#include <orbgui/instances.hpp>
 #include <orbgui/orbgui.hpp>
+#include <orbgui/plot.hpp>
 
 using namespace orb;
 
@@ -22,23 +29,121 @@ auto main() -> int
         auto gui_backend = orb::gui::instance_t::create(sample.get_gui_create_info())
                                .unwrap();
 
+        auto plot = gui_backend.create_plot({
+                                   .x        = 20.0f,
+                                   .y        = 20.0f,
+                                   .width    = 600,
+                                   .height   = 200.0f,
+                                   .capacity = 10'000'000,
+                                   .y_min    = -1.5f,
+                                   .y_max    = 1.5f,
+                                   .colors   = { { 0.2f, 0.8f, 0.3f }, { 0.9f, 0.6f, 0.1f } },
+                               })
+                        .unwrap();
+
+        // Rounded frame around the plot, clipped in the shader
+        plot->set_clip(gui_backend.clips().push({ .x = 20.0f, .y = 20.0f, .width = 600.0f, .height = 200.0f, .radius = 12.0f }));
+        gui_backend.clips().pop();
+
+        // A million cells living on the GPU, only the few thousand within
+        // their panel are drawn
+        constexpr ui32 grid_side = 1024;
+
+        auto cells = gui_backend.create_instance_set({ .viewport = 0, .capacity = grid_side * grid_side }).unwrap();
+
+        const ui32 cells_clip = gui_backend.clips().push({ .x = 20.0f, .y = 240.0f, .width = 600.0f, .height = 300.0f, .radius = 12.0f });
+        gui_backend.clips().pop();
+
+        std::vector<orb::gui::instance_item_t> row(grid_side);
+
+        for (ui32 y = 0; y < grid_side; ++y)
+        {
+            for (ui32 x = 0; x < grid_side; ++x)
+            {
+                const auto fx = static_cast<f32>(x);
+                const auto fy = static_cast<f32>(y);
+
+                row[x] = {
+                    .rect  = { fx * 8.0f, fy * 8.0f, fx * 8.0f + 7.0f, fy * 8.0f + 7.0f },
+                    .color = { fx / grid_side, fy / grid_side, 0.5f, 1.0f },
+                    .clip  = cells_clip,
+                };
+            }
+
+            cells->write(y * grid_side, row).unwrap();
+        }
+
+        // Telemetry panel published by its own thread, at its own cadence
+        auto panel = gui_backend.create_draw_list({ .viewport = 0, .layer = 0 }).unwrap();
+
+        // Slides and fades in on the GPU, its vertices are untouched
+        auto&      animator   = gui_backend.animator();
+        const ui32 panel_node = animator.create_node();
+        animator.set(panel_node, orb::gui::node_channel::translate_x, 0.5f);
+        animator.set(panel_node, orb::gui::node_channel::opacity, 0.0f);
+        animator.animate(panel_node, orb::gui::node_channel::translate_x, 0.0f, 600.0);
+        animator.animate(panel_node, orb::gui::node_channel::opacity, 1.0f, 600.0);
+
+        std::jthread telemetry([panel, panel_node](std::stop_token const& stop) {
+            panel->set_node(panel_node);
+
+            for (ui32 tick = 0; !stop.stop_requested(); ++tick)
+            {
+                const f32 level = 0.5f + 0.5f * std::sin(static_cast<f32>(tick) * 0.1f);
+
+                panel->add_rect(0.6f, 0.4f, 0.9f, 0.9f, { 0.15f, 0.15f, 0.2f });
+                panel->set_layer(1);
+                panel->add_rect(0.65f, 0.85f - 0.4f * level, 0.85f, 0.85f, { 0.3f, 0.6f, 0.9f });
+                panel->set_layer(0);
+                panel->publish();
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        });
+
+        gui_backend.set_frame_pacing({ .mode = orb::gui::pacing_mode::low_latency });
+
+        std::vector<f32> samples(5'000);
+        ui64             sample_index = 0;
+
         while (!sample.window_should_close())
         {
             sample.begin_loop_step().unwrap();
 
             if (sample.is_resize_required())
             {
-                gui_backend.on_resize().unwrap();
+                gui_backend.on_resize(0, sample.extent().width, sample.extent().height).unwrap();
                 continue;
             }
 
+            // Build as late as possible with the freshest input
+            gui_backend.wait_input_latch();
+            sample.poll_input();
+
+            for (ui32 series = 0; series < plot->series_count(); ++series)
+            {
+                for (size_t i = 0; i < samples.size(); ++i)
+                {
+                    const auto t = static_cast<f32>(sample_index + i) * 1e-4f;
+                    samples[i]   = std::sin(t * static_cast<f32>(series + 1)) + 0.2f * std::sin(t * 97.0f);
+                }
+
+                plot->append(series, samples);
+            }
+
+            sample_index += samples.size();
+
+            // Panning only changes the transform, the cells are never resent
+            const f32 pan = std::fmod(static_cast<f32>(sample_index) * 1e-4f, 7000.0f);
+            cells->set_transform({ .scale = { 1.0f, 1.0f }, .offset = { 20.0f - pan, 240.0f - pan * 0.5f } });
+
             gui_backend.render();
 
             sample.end_loop_step(gui_backend.rendered_image(), gui_backend.render_finished()).unwrap();
 
             if (sample.is_resize_required())
             {
-                gui_backend.on_resize().unwrap();
+                gui_backend.on_resize(0, sample.extent().width, sample.extent().height).unwrap();
                 continue;
             }
         }
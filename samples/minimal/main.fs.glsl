@@ -1,9 +1,31 @@
 #version 450
 
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) flat in vec4 fragClipRect;
+layout(location = 2) flat in vec4 fragClipBounds;
+layout(location = 3) flat in float fragClipRadius;
+layout(location = 4) in float fragOpacity;
 
 layout(location = 0) out vec4 outColor;
 
+// Signed distance to a rectangle with rounded corners, negative inside
+float roundedRectDistance(vec2 p, vec4 rect, float radius) {
+    vec2 center = (rect.xy + rect.zw) * 0.5;
+    vec2 halfSize = (rect.zw - rect.xy) * 0.5;
+    vec2 q = abs(p - center) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    vec2 p = gl_FragCoord.xy;
+
+    if (any(lessThan(p, fragClipBounds.xy)) || any(greaterThanEqual(p, fragClipBounds.zw))) {
+        discard;
+    }
+
+    if (fragClipRadius > 0.0 && roundedRectDistance(p, fragClipRect, fragClipRadius) > 0.0) {
+        discard;
+    }
+
+    outColor = vec4(fragColor, fragOpacity);
 }
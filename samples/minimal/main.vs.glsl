@@ -3,9 +3,41 @@
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 
+// Clip of the draw, per instance
+layout(location = 2) in vec4 inClipRect;
+layout(location = 3) in vec4 inClipBounds;
+layout(location = 4) in vec2 inClipShape;
+
+// Node of the vertex, its transform and opacity animate without re-uploads
+layout(location = 5) in uint inNode;
+
+struct Node {
+    vec4 linear;
+    vec2 translate;
+    float opacity;
+    float reserved;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Nodes { Node nodes[]; };
+
+layout(push_constant) uniform Constants {
+    uint nodeBase;
+    uint nodeCount;
+} pc;
+
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) flat out vec4 fragClipRect;
+layout(location = 2) flat out vec4 fragClipBounds;
+layout(location = 3) flat out float fragClipRadius;
+layout(location = 4) out float fragOpacity;
 
 void main() {
-    gl_Position = vec4(inPosition, 0.0, 1.0);
+    Node node = nodes[pc.nodeBase + (inNode < pc.nodeCount ? inNode : 0u)];
+
+    gl_Position = vec4(mat2(node.linear.xy, node.linear.zw) * inPosition + node.translate, 0.0, 1.0);
+    fragOpacity = node.opacity;
     fragColor = inColor;
+    fragClipRect = inClipRect;
+    fragClipBounds = inClipBounds;
+    fragClipRadius = inClipShape.x;
 }
@@ -4,7 +4,10 @@
 #include <orb/renderer.hpp>
 #include <orb/time.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <thread>
+#include <vector>
 
 using namespace orb;
 
@@ -31,8 +34,11 @@ struct renderer_t
     box<vk::cmd_pool_t>      graphics_cmd_pool;
     box<vk::cmd_pool_t>      transfer_cmd_pool;
     vk::cmd_buffers_t        blit_cmds;
-    ui32                     frame     = 0;
-    ui32                     img_index = 0;
+    ui32                     frame               = 0;
+    ui32                     img_index           = 0;
+    bool                     multi_draw_indirect = false;
+    bool                     draw_indirect_count = false;
+    std::vector<const char*> device_extensions; // enabled on the device, reported to the GUI
 };
 
 sample_t::~sample_t() = default;
@@ -97,13 +103,62 @@ auto sample_t::create() -> orb::result<sample_t>
                  transfer_qf->index,
                  transfer_qf->properties.queueCount);
 
-    b->device = vk::device_builder_t::prepare(b->instance->handle)
-                    .unwrap()
-                    .add_extension(vk::khr_extensions::swapchain)
-                    .add_queue(graphics_qf, 1.0f)
-                    .add_queue(transfer_qf, 1.0f)
-                    .build(*b->gpu)
-                    .unwrap();
+    // GUI instance sets draw indirectly, drawIndirectCount only when supported
+    VkPhysicalDeviceVulkan12Features supported_12 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    };
+
+    VkPhysicalDeviceFeatures2 supported {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &supported_12,
+    };
+
+    vkGetPhysicalDeviceFeatures2(b->gpu->handle, &supported);
+
+    b->multi_draw_indirect = supported.features.multiDrawIndirect && supported.features.drawIndirectFirstInstance;
+    b->draw_indirect_count = b->multi_draw_indirect && supported_12.drawIndirectCount;
+
+    VkPhysicalDeviceVulkan12Features enabled_12 {
+        .sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .drawIndirectCount = b->draw_indirect_count ? VK_TRUE : VK_FALSE,
+    };
+
+    VkPhysicalDeviceFeatures2 enabled {
+        .sType    = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext    = &enabled_12,
+        .features = {
+            .multiDrawIndirect         = b->multi_draw_indirect ? VK_TRUE : VK_FALSE,
+            .drawIndirectFirstInstance = b->multi_draw_indirect ? VK_TRUE : VK_FALSE,
+        },
+    };
+
+    // GUI memory pools check new blocks against the heap budgets when supported
+    ui32 extension_count = 0;
+    vkEnumerateDeviceExtensionProperties(b->gpu->handle, nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(extension_count);
+    vkEnumerateDeviceExtensionProperties(b->gpu->handle, nullptr, &extension_count, extensions.data());
+
+    const bool memory_budget = std::ranges::any_of(extensions, [](VkExtensionProperties const& extension) {
+        return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+    });
+
+    auto device_builder = vk::device_builder_t::prepare(b->instance->handle).unwrap();
+
+    device_builder.add_extension(vk::khr_extensions::swapchain)
+        .add_queue(graphics_qf, 1.0f)
+        .add_queue(transfer_qf, 1.0f)
+        .add_features(&enabled);
+
+    b->device_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+    if (memory_budget)
+    {
+        device_builder.add_extension(vk::extensions::memory_budget);
+        b->device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    b->device = device_builder.build(*b->gpu).unwrap();
 
     b->swapchain = vk::swapchain_builder_t::prepare(b->instance.getmut(),
                                                     b->gpu.getmut(),
@@ -213,6 +268,11 @@ auto sample_t::begin_loop_step() -> orb::result<void>
     return {};
 }
 
+void sample_t::poll_input()
+{
+    m_renderer->glfw_driver->poll_events();
+}
+
 auto sample_t::end_loop_step(VkImage gui_img, orb::vk::semaphores_view_t& gui_rendered_sem) -> orb::result<void>
 {
     auto blit_cmd      = m_renderer->blit_cmds.get(m_renderer->frame).unwrap();
@@ -279,16 +339,30 @@ auto sample_t::terminate() -> orb::result<void>
     return m_renderer->device->wait();
 }
 
+auto sample_t::extent() const -> VkExtent2D
+{
+    return m_renderer->swapchain->extent;
+}
+
 auto sample_t::get_gui_create_info() -> orb::gui::instance_create_info_t
 {
+    VkPhysicalDeviceProperties gpu_properties;
+    vkGetPhysicalDeviceProperties(m_renderer->gpu->handle, &gpu_properties);
+
     return orb::gui::instance_create_info_t {
-        .device         = m_renderer->device.getmut(),
-        .extent_width   = m_renderer->swapchain->extent.width,
-        .extent_height  = m_renderer->swapchain->extent.height,
-        .graphics_queue = m_renderer->graphics_qf->queues.front(),
-        .transfer_queue = m_renderer->transfer_qf->queues.front(),
-        .graphics_qf    = m_renderer->graphics_qf->index,
-        .transfer_qf    = m_renderer->transfer_qf->index,
+        .device              = m_renderer->device.getmut(),
+        .extent_width        = m_renderer->swapchain->extent.width,
+        .extent_height       = m_renderer->swapchain->extent.height,
+        .graphics_queue      = m_renderer->graphics_qf->queues.front(),
+        .transfer_queue      = m_renderer->transfer_qf->queues.front(),
+        .graphics_qf         = m_renderer->graphics_qf->index,
+        .transfer_qf         = m_renderer->transfer_qf->index,
+        .timestamp_period    = gpu_properties.limits.timestampPeriod,
+        .gpu                 = m_renderer->gpu->handle,
+        .shader_dir          = SAMPLE_DIR,
+        .device_extensions   = m_renderer->device_extensions,
+        .multi_draw_indirect = m_renderer->multi_draw_indirect,
+        .draw_indirect_count = m_renderer->draw_indirect_count,
     };
 }
 
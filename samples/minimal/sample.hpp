@@ -32,6 +32,7 @@ public:
 
     [[nodiscard]] auto window_should_close() const -> bool;
     [[nodiscard]] auto begin_loop_step() -> orb::result<void>;
+    void               poll_input();
     [[nodiscard]] auto end_loop_step(VkImage                     gui_img,
                                      orb::vk::semaphores_view_t& gui_rendered_sem) -> orb::result<void>;
 
@@ -40,6 +41,7 @@ public:
     auto get_gui_create_info() -> orb::gui::instance_create_info_t;
 
     [[nodiscard]] auto is_resize_required() const -> bool { return m_resize_required; }
+    [[nodiscard]] auto extent() const -> VkExtent2D;
 
 private:
     orb::box<renderer_t> m_renderer;
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <orb/renderer.hpp>
+
+#include "sample.hpp"
+
+#include <orbgui/orbgui.hpp>
+#include <orbgui/plot.hpp>
+#include <orbgui/remote.hpp>
+
+using namespace orb;
+
+// Builds the GUI without any device and streams it to the receiver
+static auto run_sender(std::string const& channel, ui32 width, ui32 height) -> int
+{
+    auto sender = orb::gui::remote_sender_t::create({
+                                                .channel   = channel,
+                                                .viewports = { { .extent_width = width, .extent_height = height } },
+                                            })
+                      .unwrap();
+
+    auto plot = sender.create_plot({
+                              .x        = 20.0f,
+                              .y        = 20.0f,
+                              .width    = 600,
+                              .height   = 200.0f,
+                              .capacity = 10'000'000,
+                              .y_min    = -1.5f,
+                              .y_max    = 1.5f,
+                              .colors   = { { 0.2f, 0.8f, 0.3f }, { 0.9f, 0.6f, 0.1f } },
+                          })
+                    .unwrap();
+
+    std::vector<f32> samples(5'000);
+    ui64             sample_index = 0;
+    ui64             frames       = 0;
+    auto             report       = std::chrono::steady_clock::now();
+
+    fmt::println("- Publishing on channel {}", channel);
+
+    while (true)
+    {
+        for (ui32 series = 0; series < plot->series_count(); ++series)
+        {
+            for (size_t i = 0; i < samples.size(); ++i)
+            {
+                const auto t = static_cast<f32>(sample_index + i) * 1e-4f;
+                samples[i]   = std::sin(t * static_cast<f32>(series + 1)) + 0.2f * std::sin(t * 97.0f);
+            }
+
+            plot->append(series, samples);
+        }
+
+        sample_index += samples.size();
+
+        sender.publish().unwrap();
+        ++frames;
+
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now - report >= std::chrono::seconds(1))
+        {
+            const auto raw = static_cast<f64>(plot->vertex_count() * sizeof(orb::gui::vertex_t)) * static_cast<f64>(frames);
+
+            fmt::println("- {:.2f} MB sent ({:.1f}x smaller than full uploads), {} frames dropped",
+                         static_cast<f64>(sender.bytes_sent()) / 1e6,
+                         raw / static_cast<f64>(std::max<ui64>(sender.bytes_sent(), 1)),
+                         sender.frames_dropped());
+
+            report = now;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+
+    return 0;
+}
+
+// Draws what the sender publishes, the only GUI work left here is render()
+static auto run_receiver(std::string const& channel) -> int
+{
+    auto receiver = orb::gui::remote_receiver_t::open(channel).unwrap();
+
+    auto sample = sample_t::create().unwrap();
+
+    auto gui_backend = orb::gui::instance_t::create(sample.get_gui_create_info())
+                           .unwrap();
+
+    orb::gui::replay_frame_t frame;
+
+    while (!sample.window_should_close())
+    {
+        sample.begin_loop_step().unwrap();
+
+        if (sample.is_resize_required())
+        {
+            gui_backend.on_resize(0, sample.extent().width, sample.extent().height).unwrap();
+            continue;
+        }
+
+        receiver.poll(frame).unwrap();
+        gui_backend.render_replay(frame).unwrap();
+
+        sample.end_loop_step(gui_backend.rendered_image(), gui_backend.render_finished()).unwrap();
+    }
+
+    sample.terminate().unwrap();
+
+    return 0;
+}
+
+// Remote GUI over shared memory. Start the sender first, then the receiver
+// with the same channel
+auto main(int argc, char** argv) -> int
+{
+    if (argc < 3)
+    {
+        fmt::println("usage: remote --send <channel> [width height] | --receive <channel>");
+        return 1;
+    }
+
+    try
+    {
+        const std::string_view mode = argv[1];
+
+        if (mode == "--send")
+        {
+            const ui32 width  = argc > 4 ? static_cast<ui32>(std::stoul(argv[3])) : 800;
+            const ui32 height = argc > 4 ? static_cast<ui32>(std::stoul(argv[4])) : 600;
+
+            return run_sender(argv[2], width, height);
+        }
+
+        if (mode == "--receive")
+        {
+            return run_receiver(argv[2]);
+        }
+
+        fmt::println("Unknown mode {}", mode);
+        return 1;
+    }
+    catch (const orb::exception& e)
+    {
+        fmt::println("Fatal error: {}", e.what());
+        return 1;
+    }
+}
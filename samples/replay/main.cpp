@@ -0,0 +1,125 @@
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <orb/renderer.hpp>
+
+#include "sample.hpp"
+
+#include <orbgui/capture.hpp>
+#include <orbgui/orbgui.hpp>
+
+using namespace orb;
+
+// Replays a capture recorded with instance_t::begin_capture(). With --cpu,
+// frames are only decoded, without window nor device, to profile the CPU path
+auto main(int argc, char** argv) -> int
+{
+    if (argc < 2)
+    {
+        fmt::println("usage: replay <capture> [--cpu] [--loops N]");
+        return 1;
+    }
+
+    try
+    {
+        bool cpu_only = false;
+        ui32 loops    = 1;
+
+        for (int i = 2; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+
+            if (arg == "--cpu")
+            {
+                cpu_only = true;
+            }
+            else if (arg == "--loops" && i + 1 < argc)
+            {
+                loops = static_cast<ui32>(std::stoul(argv[++i]));
+            }
+        }
+
+        auto capture = orb::gui::capture_file_t::open(argv[1]).unwrap();
+        auto frames  = capture.frames();
+
+        fmt::println("- Loaded {} frames", frames.size());
+
+        if (frames.empty())
+        {
+            return 0;
+        }
+
+        orb::gui::replay_frame_t frame;
+
+        if (cpu_only)
+        {
+            size_t uploaded = 0;
+            size_t draws    = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for (ui32 loop = 0; loop < loops; ++loop)
+            {
+                for (auto const& captured : frames)
+                {
+                    orb::gui::decode_capture_frame(captured, frame).unwrap();
+
+                    for (auto const& upload : frame.uploads)
+                    {
+                        uploaded += upload.data.size();
+                    }
+
+                    for (auto const& pass : frame.passes)
+                    {
+                        draws += pass.draws.size();
+                    }
+                }
+            }
+
+            const auto elapsed = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - start).count();
+            const auto count   = static_cast<f64>(frames.size()) * loops;
+
+            fmt::println("- Decoded {} frames in {:.1f} us ({:.3f} us/frame)", count, elapsed, elapsed / count);
+            fmt::println("- {:.2f} MB uploaded, {} draws", static_cast<f64>(uploaded) / 1e6, draws);
+
+            return 0;
+        }
+
+        auto sample = sample_t::create().unwrap();
+
+        auto gui_backend = orb::gui::instance_t::create(sample.get_gui_create_info())
+                               .unwrap();
+
+        size_t index  = 0;
+        ui32   played = 0;
+
+        while (!sample.window_should_close() && played < loops)
+        {
+            sample.begin_loop_step().unwrap();
+
+            if (sample.is_resize_required())
+            {
+                gui_backend.on_resize(0, sample.extent().width, sample.extent().height).unwrap();
+                continue;
+            }
+
+            orb::gui::decode_capture_frame(frames[index], frame).unwrap();
+            gui_backend.render_replay(frame).unwrap();
+
+            sample.end_loop_step(gui_backend.rendered_image(), gui_backend.render_finished()).unwrap();
+
+            index = (index + 1) % frames.size();
+            played += index == 0 ? 1 : 0;
+        }
+
+        sample.terminate().unwrap();
+    }
+    catch (const orb::exception& e)
+    {
+        fmt::println("Fatal error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}